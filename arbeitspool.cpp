@@ -0,0 +1,42 @@
+#include "arbeitspool.hpp"
+
+Arbeitspool::Arbeitspool(unsigned int anzahlThreads) {
+  for (unsigned int i = 1; i < anzahlThreads; ++i) {
+    m_threads.emplace_back([this]() { Arbeite(); });
+  }
+}
+
+Arbeitspool::~Arbeitspool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_beenden = true;
+  }
+  m_aufgabeCv.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void Arbeitspool::Einreihen(std::function<void()> aufgabe) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_aufgaben.push(std::move(aufgabe));
+  }
+  m_aufgabeCv.notify_one();
+}
+
+void Arbeitspool::Arbeite() {
+  while (true) {
+    std::function<void()> aufgabe;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_aufgabeCv.wait(lock, [this]() { return m_beenden || !m_aufgaben.empty(); });
+      if (m_aufgaben.empty()) {
+        return;
+      }
+      aufgabe = std::move(m_aufgaben.front());
+      m_aufgaben.pop();
+    }
+    aufgabe();
+  }
+}
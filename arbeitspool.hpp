@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Einfacher Threadpool fuer datenparallele Schleifen.
+// Der aufrufende Thread arbeitet in ParallelFuer mit, deshalb kann ParallelFuer auch innerhalb
+// einer Aufgabe des Pools verschachtelt aufgerufen werden, ohne dass Threads aufeinander warten.
+class Arbeitspool {
+ public:
+  // `anzahlThreads` ist die Gesamtzahl gleichzeitig arbeitender Threads einschliesslich des aufrufenden.
+  explicit Arbeitspool(unsigned int anzahlThreads);
+  ~Arbeitspool();
+
+  Arbeitspool(const Arbeitspool&) = delete;
+  Arbeitspool& operator=(const Arbeitspool&) = delete;
+
+  unsigned int anzahlThreads() const { return static_cast<unsigned int>(m_threads.size()) + 1; }
+
+  // Ruft `f(i)` fuer alle i in [0, n) auf, verteilt auf die Threads des Pools, und kehrt zurueck,
+  // wenn alle Aufrufe beendet sind. Die Reihenfolge der Aufrufe ist nicht festgelegt.
+  // Wirft ein Aufruf eine Ausnahme, werden keine weiteren Indizes mehr vergeben; nachdem die bereits
+  // begonnenen Aufrufe beendet sind, wird die erste Ausnahme im aufrufenden Thread weitergeworfen.
+  template<typename F>
+  void ParallelFuer(size_t n, F&& f) {
+    if (n == 0) {
+      return;
+    }
+    if (n == 1 || m_threads.empty()) {
+      for (size_t i = 0; i < n; ++i) {
+        f(i);
+      }
+      return;
+    }
+
+    auto auftrag = std::make_shared<Auftrag>();
+    auftrag->n = n;
+    auftrag->ende = n;
+    auftrag->f = [&f](size_t i) { f(i); };
+    for (size_t i = 0, len = std::min<size_t>(n - 1, m_threads.size()); i < len; ++i) {
+      Einreihen([auftrag]() { auftrag->Abarbeiten(); });
+    }
+    auftrag->Abarbeiten();
+
+    std::unique_lock<std::mutex> lock(auftrag->mutex);
+    auftrag->fertigCv.wait(lock, [&auftrag]() { return auftrag->fertig == auftrag->ende; });
+    if (auftrag->fehler) {
+      // Herausnehmen, damit die Ausnahme nicht von einem Thread freigegeben wird, der den Auftrag spaeter loslaesst
+      const auto fehler = std::move(auftrag->fehler);
+      lock.unlock();
+      std::rethrow_exception(fehler);
+    }
+  }
+
+ private:
+  // Eine Schleife [0, n), deren Indizes sich die beteiligten Threads teilen.
+  struct Auftrag {
+    size_t n = 0;
+    std::function<void(size_t)> f;
+    std::atomic<size_t> naechster { 0 };
+    std::mutex mutex;
+    std::condition_variable fertigCv;
+    size_t fertig = 0;            // Anzahl beendeter Aufrufe
+    size_t ende = SIZE_MAX;       // Anzahl insgesamt vergebener Indizes: n, nach einer Ausnahme weniger
+    std::exception_ptr fehler;    // erste Ausnahme aus f
+
+    void Abarbeiten() {
+      size_t anzahl = 0;
+      for (size_t i = naechster++; i < n; i = naechster++) {
+        try {
+          f(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!fehler) {
+            fehler = std::current_exception();
+            // Ab hier liefert naechster++ nur noch Werte >= n. Alle kleineren Werte wurden schon vergeben
+            // und werden von ihren Threads noch abgearbeitet und gezaehlt.
+            ende = std::min(naechster.exchange(n), n);
+          }
+        }
+        ++anzahl;
+      }
+      if (anzahl > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fertig += anzahl;
+        if (fertig == ende) {
+          fertigCv.notify_all();
+        }
+      }
+    }
+  };
+
+  void Einreihen(std::function<void()> aufgabe);
+  void Arbeite();
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_aufgabeCv;
+  std::queue<std::function<void()>> m_aufgaben;
+  bool m_beenden = false;
+};
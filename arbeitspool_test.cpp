@@ -0,0 +1,78 @@
+// Prueft die Fehlerbehandlung von Arbeitspool::ParallelFuer: Eine Ausnahme aus einer verschachtelten Schleife
+// kommt beim aeusseren Aufrufer an, alle begonnenen Aufrufe sind dann beendet, und der Pool bleibt benutzbar.
+
+#include "arbeitspool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+int anzahlFehler = 0;
+
+void Pruefe(bool bedingung, const char* beschreibung) {
+  if (!bedingung) {
+    std::cout << "FEHLER: " << beschreibung << "\n";
+    ++anzahlFehler;
+  }
+}
+
+}  // namespace
+
+int main() {
+  Arbeitspool pool(4);
+
+  // Ausnahme in einer verschachtelten Schleife auf einem beliebigen Thread
+  for (int durchlauf = 0; durchlauf < 100; ++durchlauf) {
+    std::atomic<int> laufend { 0 };
+    std::atomic<int> aufrufe { 0 };
+    bool gefangen = false;
+    try {
+      pool.ParallelFuer(8, [&](size_t aussen) {
+        pool.ParallelFuer(64, [&](size_t innen) {
+          ++laufend;
+          ++aufrufe;
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+          --laufend;
+          if (aussen == 3 && innen == 17) {
+            throw std::runtime_error("innen " + std::to_string(innen));
+          }
+        });
+      });
+    } catch (const std::runtime_error& e) {
+      gefangen = (std::string(e.what()) == "innen 17");
+    }
+    Pruefe(gefangen, "Ausnahme aus verschachteltem ParallelFuer wird im Aufrufer gefangen");
+    Pruefe(laufend == 0, "Nach der Ausnahme laeuft kein Aufruf mehr");
+    Pruefe(aufrufe <= 8 * 64, "Kein Index wird mehrfach vergeben");
+  }
+
+  // Ausnahme auf dem aufrufenden Thread selbst (n groesser als die Anzahl Threads)
+  {
+    bool gefangen = false;
+    try {
+      pool.ParallelFuer(1000, [](size_t i) {
+        if (i % 100 == 99) {
+          throw std::logic_error("mehrere");
+        }
+      });
+    } catch (const std::logic_error&) {
+      gefangen = true;
+    }
+    Pruefe(gefangen, "Ausnahme bei mehreren fehlschlagenden Aufrufen wird einmal geworfen");
+  }
+
+  // Pool ist danach weiter benutzbar
+  std::atomic<size_t> summe { 0 };
+  pool.ParallelFuer(1000, [&summe](size_t i) { summe += i; });
+  Pruefe(summe == 999 * 1000 / 2, "ParallelFuer nach einer Ausnahme ruft alle Indizes auf");
+
+  if (anzahlFehler == 0) {
+    std::cout << "arbeitspool_test: ok\n";
+  }
+  return anzahlFehler == 0 ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+#include "bogenweichen.hpp"
+
+#include "geometriekerne.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+double GetKruemmung(const ElementUndRichtung& ER) {
+  return ER.second ? ER.first->kr : -ER.first->kr;
+}
+
+double HundertstelGrad(double rad) {
+  return 100 * (rad * 180.0 / M_PI);
+}
+
+ElementUndRichtung GetElementUndRichtung(const Strecke& str, ElementRichtung er) {
+  if (er == KEIN_ELEMENT) {
+    return { nullptr, false };
+  }
+  return { str.children_StrElement[Nummer(er)].get(), Normrichtung(er) };
+}
+
+std::vector<Weiche> FindeWeichen(const Strecke& str, const Streckengraph& graph, Protokoll& log, bool nurBogenweichen) {
+  std::vector<Weiche> result;
+
+  const auto folgeWeichenstrang = [&str, &graph](ElementRichtung el) -> std::vector<ElementUndRichtung> {
+    std::vector<ElementUndRichtung> result;
+    ElementRichtung cur = el;
+    while (cur != KEIN_ELEMENT && (graph.anzahlNachfolger(cur) <= 1) && (graph.funktion(Nummer(cur)) & WEICHE)) {
+      result.push_back(GetElementUndRichtung(str, cur));
+      cur = graph.nachfolger(cur, 0);
+    }
+    return result;
+  };
+
+  for (size_t nr = 0; nr < graph.anzahlElemente(); ++nr) {
+    if (!graph.vorhanden(nr)) {
+      continue;
+    }
+
+    if ((graph.funktion(nr) & WEICHE) &&
+        (graph.anzahlNachfolger(MitRichtung(nr, true)) == 2 || graph.anzahlNachfolger(MitRichtung(nr, false)) == 2)) {
+
+      const auto& str_element = str.children_StrElement[nr];
+      const bool norm = (graph.anzahlNachfolger(MitRichtung(nr, true)) == 2);
+      const ElementRichtung start = MitRichtung(nr, norm);
+
+      const auto& richtungsInfo = (norm ? str_element->InfoNormRichtung : str_element->InfoGegenRichtung);
+      if (!richtungsInfo.has_value()) {
+        if (log.fehler()) {
+          log << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber enthaelt keine Richtungsinformation\n";
+        }
+        continue;
+      }
+
+      const auto& signal = richtungsInfo->Signal;
+      if (!signal) {
+        if (log.fehler()) {
+          log << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber enthaelt kein Signal\n";
+        }
+        continue;
+      }
+      if (signal->children_SignalFrame.empty()) {
+        if (log.fehler()) {
+          log << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber das Signal enthaelt keine Signalframes\n";
+        }
+        continue;
+      }
+
+      const auto& signalFrame = signal->children_SignalFrame[0];
+      const auto& dateiname = signalFrame->Datei.Dateiname;
+
+      if (nurBogenweichen && (dateiname.find("gebogen") == std::string::npos)) {
+        continue;
+      }
+
+      if ((dateiname.find("DKW") != std::string::npos)
+          || (dateiname.find("EKW") != std::string::npos)
+          || (dateiname.find("symm ABW") != std::string::npos)
+          || (dateiname.find("symm_ABW") != std::string::npos)
+          || (dateiname.find("WA-WM") != std::string::npos)
+          || (dateiname.find("Zunge") != std::string::npos)
+          || (dateiname.find("ZDW") != std::string::npos)) {
+        continue;
+      }
+
+      result.push_back(Weiche {
+          signal.get(),
+          { str_element.get(), norm },
+          folgeWeichenstrang(graph.nachfolger(start, 0)),
+          folgeWeichenstrang(graph.nachfolger(start, 1)) });
+    }
+  }
+
+  return result;
+}
+
+double Radius(double kr) {
+  return kr == 0.0f ? std::numeric_limits<double>::infinity() : 1/kr;
+}
+
+const Vec3& GetElementEnde(const ElementUndRichtung& elementRichtung, ElementEnde ende) {
+  return (elementRichtung.second == (ende == ElementEnde::Anfang)) ? elementRichtung.first->g : elementRichtung.first->b;
+}
+
+double WinkelDiff(double phi1, double phi2) {
+  // phi1, phi2 sind Winkel aus GetWinkel: Sehnenwinkel im Intervall [-π, π] plus Tangentenwinkel bis π/2
+  const auto result = std::abs(phi1 - phi2);           // im Intervall [0, 3π]
+  return std::min(result, std::abs(result - 2 * M_PI));  // im Intervall [0, π]
+}
+
+bool LinksVon(double phi1, double phi2) {
+  const auto diff = phi1 - phi2;
+  return (diff > 0) || (diff < -M_PI);
+}
+
+double GetWinkel(const Geometrietabelle& geometrie, const ElementUndRichtung& elementRichtung, ElementEnde ende, double kr /* in Normrichtung */) {
+  const size_t nr = elementRichtung.first->Nr;
+  double result = geometrie.sehnenwinkel(nr, elementRichtung.second);  // Winkel ohne Kruemmung
+
+  if (!elementRichtung.second) {
+    kr = -kr;
+  }
+  const double tangentenwinkel = Tangentenwinkel(geometrie.laenge(nr), kr);
+  if ((kr > 0) == (ende == ElementEnde::Anfang)) {
+    // Positive Kruemmung: Linksbogen -> erst Ausschlag nach rechts, also gegen Uhrzeigersinn
+    result -= tangentenwinkel;
+  } else {
+    result += tangentenwinkel;
+  }
+
+  return result;
+}
+
+double GetWinkel(const Geometrietabelle& geometrie, const ElementUndRichtung& elementRichtung, ElementEnde ende) {
+  const size_t nr = elementRichtung.first->Nr;
+  const double kr = GetKruemmung(elementRichtung);
+  double result = geometrie.sehnenwinkel(nr, elementRichtung.second);
+  if ((kr > 0) == (ende == ElementEnde::Anfang)) {
+    result -= geometrie.tangentenwinkel(nr);
+  } else {
+    result += geometrie.tangentenwinkel(nr);
+  }
+  return result;
+}
+
+double GetWinkel(const Geometrietabelle& geometrie, ElementRichtung elementRichtung, ElementEnde ende) {
+  const size_t nr = Nummer(elementRichtung);
+  const double kr = Normrichtung(elementRichtung) ? geometrie.kruemmung(nr) : -geometrie.kruemmung(nr);
+  double result = geometrie.sehnenwinkel(nr, Normrichtung(elementRichtung));
+  if ((kr > 0) == (ende == ElementEnde::Anfang)) {
+    result -= geometrie.tangentenwinkel(nr);
+  } else {
+    result += geometrie.tangentenwinkel(nr);
+  }
+  return result;
+}
+
+std::vector<size_t> BerechneElementZuordnung(const std::vector<ElementUndRichtung>& vec, const Geometrietabelle& geometrieVec,
+    const std::vector<ElementUndRichtung>& referenz, const Geometrietabelle& geometrieReferenz) {
+  std::vector<size_t> result;
+  result.reserve(vec.size());
+  auto itReferenz = referenz.begin();
+
+  constexpr double epsilon = 0.3;  // Erlaubte Laengenabweichung zwischen Original- und verbogenem Element
+
+  double ldiff = -geometrieReferenz.laenge(itReferenz->first->Nr);  // Lauflaenge vec - Lauflaenge referenz
+  for (size_t i = 0, len = vec.size(); i < len; ++i) {
+    const auto& el = vec[i];
+
+    assert(itReferenz != referenz.end());
+    result.push_back(itReferenz - referenz.begin());
+
+    ldiff += geometrieVec.laenge(el.first->Nr);
+    if (std::abs(ldiff) <= epsilon) {
+      ldiff = 0;
+    }
+
+    if (i < len - 1) {
+      while (ldiff > -epsilon) {
+        ++itReferenz;
+        assert(itReferenz != referenz.end());
+        ldiff -= geometrieReferenz.laenge(itReferenz->first->Nr);
+      }
+    }
+  }
+
+  assert(ldiff > -epsilon);
+
+  return result;
+}
+
+std::vector<std::pair<double, double>> BerechneBiegeparameter(
+    const std::vector<ElementUndRichtung>& unverbogen, const Geometrietabelle& geometrieUnverbogen,
+    const std::vector<ElementUndRichtung>& verbogen, const Geometrietabelle& geometrieVerbogen,
+    Protokoll& log) {
+  std::vector<std::pair<double, double>> result;
+  result.reserve(verbogen.size());
+
+  const auto& zuordnung = BerechneElementZuordnung(verbogen, geometrieVerbogen, unverbogen, geometrieUnverbogen);
+  double lauflaenge = 0;
+  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
+    const auto& el = verbogen[i];
+    const auto& elUnverbogen = unverbogen[zuordnung[i]];
+    const auto krdiff = GetKruemmung(el) - GetKruemmung(elUnverbogen);
+    if (log.ausfuehrlich()) {
+      log << " - Lauflaenge " << lauflaenge << ": verbogen " << el.first->Nr << " -> unverbogen " << elUnverbogen.first->Nr << ", krdiff=" << krdiff << "/Biegeradius=" << Radius(krdiff) << "\n";
+    }
+    result.emplace_back(lauflaenge, krdiff);
+
+    lauflaenge += geometrieVerbogen.laenge(el.first->Nr);
+  }
+
+  return result;
+}
+
+namespace {
+
+// Liest die Zahl, die bei `pos` beginnt. Fuehrende Leerzeichen und ein '+' werden uebersprungen,
+// ',' gilt wie '.' als Dezimaltrennzeichen. Gibt bei Fehlern false zurueck und setzt `fehler`.
+bool LiesBeschreibungszahl(std::string_view text, size_t pos, double& wert, Lesefehler& fehler) {
+  while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+    ++pos;
+  }
+  if (pos < text.size() && text[pos] == '+') {
+    ++pos;
+  }
+
+  // Ziffern mit Dezimalpunkt statt -komma in einen Puffer auf dem Stack kopieren, from_chars kennt nur '.'
+  char puffer[64];
+  size_t laenge = 0;
+  for (; pos + laenge < text.size(); ++laenge) {
+    const char c = text[pos + laenge];
+    if (!((c >= '0' && c <= '9') || c == '.' || c == ',' || c == '-' || c == '+' || c == 'e' || c == 'E')) {
+      break;
+    }
+    if (laenge == sizeof(puffer)) {
+      fehler = { pos, "Zahl zu lang" };
+      return false;
+    }
+    puffer[laenge] = (c == ',') ? '.' : c;
+  }
+
+  const auto ergebnis = std::from_chars(puffer, puffer + laenge, wert);
+  if (ergebnis.ec == std::errc::invalid_argument) {
+    fehler = { pos, "keine Zahl" };
+    return false;
+  }
+  if (ergebnis.ec == std::errc::result_out_of_range) {
+    fehler = { pos, "Zahl ausserhalb des Wertebereichs" };
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool LiesBiegeparameter(std::string_view beschreibung, double offset, std::vector<std::pair<double, double>>& ziel,
+    Lesefehler& fehler, Protokoll& log) {
+  double l = -offset;
+  double l_neu = l;
+  for (size_t pos = beschreibung.find('='); pos != std::string_view::npos; pos = beschreibung.find('=', pos + 1)) {
+    const auto schluessel = beschreibung.substr(0, pos);  // Text vor dem '=', nur das Ende ist relevant
+    double wert;
+    if (schluessel.size() >= 1 && schluessel.back() == 'l') {
+      if (!LiesBeschreibungszahl(beschreibung, pos + 1, wert, fehler)) {
+        return false;
+      }
+      l_neu += wert;
+    } else if (schluessel.size() >= 2 && schluessel.substr(schluessel.size() - 2) == "kr") {
+      if (!LiesBeschreibungszahl(beschreibung, pos + 1, wert, fehler)) {
+        return false;
+      }
+      if (log.ausfuehrlich()) {
+        log << " - Lauflaenge " << l << ": kr=" << wert << "/r=" << Radius(wert) << "\n";
+      }
+      l = l_neu;
+      if (l >= 0) {
+        ziel.emplace_back(l, wert);
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<std::pair<double, double>> LiesBiegeparameter(const Zusi& datei, double offset, Protokoll& log) {
+  std::vector<std::pair<double, double>> result;
+  Lesefehler fehler;
+  if (!LiesBiegeparameter(datei.Info->Beschreibung, offset, result, fehler, log)) {
+    if (log.fehler()) {
+      log << "Fehler beim Lesen der Dateibeschreibung an Zeichen " << (fehler.position + 1) << ": " << fehler.grund << "\n";
+    }
+    result.clear();
+  }
+  return result;
+}
+
+std::vector<std::pair<std::size_t, double>> KorrigiereKruemmungAbzweigenderStrang(
+    const ElementUndRichtung& startElementUnverbogen,
+    const ElementUndRichtung& startElementVerbogen,
+    const std::vector<ElementUndRichtung>& unverbogen,
+    const std::vector<ElementUndRichtung>& verbogen,
+    const Geometrietabelle& geometrieUnverbogen,
+    const Geometrietabelle& geometrieVerbogen,
+    const std::vector<std::pair<double, double>>& biegeparameter,
+    Protokoll& log) {
+  std::vector<std::pair<std::size_t, double>> result;
+  result.reserve(verbogen.size());
+
+  const auto& zuordnung = BerechneElementZuordnung(verbogen, geometrieVerbogen, unverbogen, geometrieUnverbogen);
+  auto itBiegeparameter = biegeparameter.begin();
+  assert(itBiegeparameter != biegeparameter.end());
+  double lauflaenge = 0;
+  double winkelVorherEndeNeu = 0;  // wird im ersten Schleifendurchlauf initialisiert
+  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
+    const auto& el = verbogen[i];
+    const auto& elUnverbogen = unverbogen[zuordnung[i]];
+
+    if ((i < len - 1 && zuordnung[i] == zuordnung[i+1]) && (i == 0 || zuordnung[i] != zuordnung[i-1])) {
+      if (log.fehler()) {
+        log << "  ! Element " << elUnverbogen.first->Nr << " wurde vom Gleisplaneditor vor dem Biegen zerteilt, vermutlich keine sinnvolle Berechnung moeglich\n";
+      }
+    }
+
+    while (lauflaenge > itBiegeparameter->first + 2.5) {
+      ++itBiegeparameter;
+      assert(itBiegeparameter != biegeparameter.end());
+    }
+
+    auto krNeu = GetKruemmung(elUnverbogen) + itBiegeparameter->second;
+    if (!el.second) {
+      krNeu = -krNeu;
+    }
+
+    // Knickwinkel werden nur fuer die Ausgabe berechnet
+    if (log.ausfuehrlich()) {
+      const auto& elVorherVerbogen = (i == 0 ? startElementVerbogen : verbogen[i-1]);
+      const auto& elVorherUnverbogen = (i == 0 ? startElementUnverbogen : unverbogen[zuordnung[i-1]]);
+
+      const auto winkelEl1EndeAlt = GetWinkel(geometrieVerbogen, elVorherVerbogen, ElementEnde::Ende);
+      if (i == 0) {
+        winkelVorherEndeNeu = winkelEl1EndeAlt;
+      }
+      const auto winkelEl2AnfangAlt = GetWinkel(geometrieVerbogen, el, ElementEnde::Anfang);
+      const auto winkelEl2AnfangNeu = GetWinkel(geometrieVerbogen, el, ElementEnde::Anfang, krNeu);
+      const auto winkelEl1UnverbogenEnde = GetWinkel(geometrieUnverbogen, elVorherUnverbogen, ElementEnde::Ende);
+      const auto winkelEl2UnverbogenAnfang = GetWinkel(geometrieUnverbogen, elUnverbogen, ElementEnde::Anfang);
+
+      const auto knickAlt = WinkelDiff(winkelEl1EndeAlt, winkelEl2AnfangAlt);
+      const auto knickNeu = WinkelDiff(winkelVorherEndeNeu, winkelEl2AnfangNeu);
+      const auto knickUnverbogen = WinkelDiff(winkelEl1UnverbogenEnde, winkelEl2UnverbogenAnfang);
+
+      log << "  > Knick " << HundertstelGrad(knickNeu)
+        << " (vs. vorher " << HundertstelGrad(knickAlt) << ": " << std::showpos << (knickAlt == 0.0 ? 0 : ((knickNeu-knickAlt)/knickAlt * 100)) << std::noshowpos << "%, "
+        << "vs. unverbogen " << HundertstelGrad(knickUnverbogen) << ": " << std::showpos << (knickUnverbogen == 0.0 ? 0 : ((knickNeu-knickUnverbogen)/knickUnverbogen * 100)) << std::noshowpos << "%)\n";
+
+      log << " - Lauflaenge " << lauflaenge << ": verbogen " << el.first->Nr << " -> unverbogen " << elUnverbogen.first->Nr << ", krdiff = " << itBiegeparameter->second << " -> setze kr=" << krNeu << "/r=" << Radius(krNeu) << "\n";
+
+      winkelVorherEndeNeu = GetWinkel(geometrieVerbogen, el, ElementEnde::Ende, krNeu);
+    }
+    result.emplace_back(el.first->Nr, krNeu);
+
+    lauflaenge += geometrieVerbogen.laenge(el.first->Nr);
+  }
+
+  return result;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include "geometrietabelle.hpp"
+#include "protokoll.hpp"
+#include "streckengraph.hpp"
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Streckenelement mit Richtung (true = Normrichtung)
+using ElementUndRichtung = std::pair<const StrElement*, bool>;
+
+// Bit fuer "Weiche" in StrElement::Fkt
+constexpr size_t WEICHE = 1 << 2;
+
+// Eine Weiche: Verzweigungselement und die Elemente beider Straenge bis zum Ende des Weichenbereichs.
+struct Weiche {
+  const Signal* weichensignal;
+  ElementUndRichtung startElement;
+  std::vector<ElementUndRichtung> geraderStrang;
+  std::vector<ElementUndRichtung> abzweigenderStrang;
+};
+
+enum class ElementEnde {
+  Anfang, Ende
+};
+
+// Kruemmung des Elements in seiner Richtung
+double GetKruemmung(const ElementUndRichtung& ER);
+
+double HundertstelGrad(double rad);
+
+// Element `er` der Strecke, {nullptr, false} fuer KEIN_ELEMENT
+ElementUndRichtung GetElementUndRichtung(const Strecke& str, ElementRichtung er);
+
+// Findet alle Weichen der Strecke (bzw. nur die Bogenweichen, deren Weichensignal auf eine verbogene Datei verweist).
+// Kreuzungsweichen, Abzweigweichen und aehnliche Bauformen werden ignoriert.
+std::vector<Weiche> FindeWeichen(const Strecke& str, const Streckengraph& graph, Protokoll& log, bool nurBogenweichen = false);
+
+double Radius(double kr);
+
+const Vec3& GetElementEnde(const ElementUndRichtung& elementRichtung, ElementEnde ende);
+
+// Betrag der Differenz zweier Richtungswinkel aus GetWinkel (bis 3π/2 vom Betrag), im Intervall [0, π]
+double WinkelDiff(double phi1, double phi2);
+
+bool LinksVon(double phi1, double phi2);
+
+// Winkel der Kreistangente am Anfang bzw. Ende des Elements, wenn es die Kruemmung `kr` haette.
+double GetWinkel(const Geometrietabelle& geometrie, const ElementUndRichtung& elementRichtung, ElementEnde ende, double kr /* in Normrichtung */);
+
+// Wie GetWinkel mit der im Element gespeicherten Kruemmung, aber ohne Winkelfunktionen.
+double GetWinkel(const Geometrietabelle& geometrie, const ElementUndRichtung& elementRichtung, ElementEnde ende);
+
+// Wie GetWinkel, aber nur aus der Geometrietabelle, ohne das Streckenelement anzufassen.
+double GetWinkel(const Geometrietabelle& geometrie, ElementRichtung elementRichtung, ElementEnde ende);
+
+// Gibt einen Vektor mit derselben Laenge wie `vec` zurueck,
+// in dessen i-tem Element der Index des zum i-ten Element aus `vec` zugehoerigen Elementes aus `referenz` steht.
+// (Zuordnung erfolgt ueber die Elementlaengen)
+std::vector<size_t> BerechneElementZuordnung(const std::vector<ElementUndRichtung>& vec, const Geometrietabelle& geometrieVec,
+    const std::vector<ElementUndRichtung>& referenz, const Geometrietabelle& geometrieReferenz);
+
+// Biegeparameter als Paare (Lauflaenge, Kruemmungsunterschied) aus dem Vergleich eines verbogenen
+// mit dem unverbogenen Strang.
+std::vector<std::pair<double, double>> BerechneBiegeparameter(
+    const std::vector<ElementUndRichtung>& unverbogen, const Geometrietabelle& geometrieUnverbogen,
+    const std::vector<ElementUndRichtung>& verbogen, const Geometrietabelle& geometrieVerbogen,
+    Protokoll& log);
+
+// Stelle und Art eines Fehlers in einer Dateibeschreibung
+struct Lesefehler {
+  size_t position = 0;     // Index des Zeichens in der Beschreibung, an dem eine Zahl erwartet wurde
+  const char* grund = "";
+};
+
+// Biegeparameter als Paare (Lauflaenge, Kruemmungsunterschied) aus der Dateibeschreibung einer verbogenen LS3-Datei
+// ("l=... kr=...", Dezimalkomma oder -punkt), in einem Durchlauf ohne Kopie der Beschreibung gelesen und an `ziel` angehaengt.
+// Die Lauflaengen werden um `offset` verschoben. Gibt false zurueck, wenn ein Wert nicht lesbar ist; `fehler` enthaelt dann
+// die Stelle und `ziel` die bis dahin gelesenen Paare.
+bool LiesBiegeparameter(std::string_view beschreibung, double offset, std::vector<std::pair<double, double>>& ziel,
+    Lesefehler& fehler, Protokoll& log);
+
+// Wie oben fuer die Beschreibung von `datei`. Bei Fehlern wird die Stelle gemeldet und eine leere Liste zurueckgegeben.
+std::vector<std::pair<double, double>> LiesBiegeparameter(const Zusi& datei, double offset, Protokoll& log);
+
+// Gibt die neuen Kruemmungen der Elemente des abzweigenden Strangs als Paare (Nr, kr) zurueck.
+std::vector<std::pair<std::size_t, double>> KorrigiereKruemmungAbzweigenderStrang(
+    const ElementUndRichtung& startElementUnverbogen,
+    const ElementUndRichtung& startElementVerbogen,
+    const std::vector<ElementUndRichtung>& unverbogen,
+    const std::vector<ElementUndRichtung>& verbogen,
+    const Geometrietabelle& geometrieUnverbogen,
+    const Geometrietabelle& geometrieVerbogen,
+    const std::vector<std::pair<double, double>>& biegeparameter,
+    Protokoll& log);
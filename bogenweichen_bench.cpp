@@ -0,0 +1,811 @@
+// Misst die Skalierung der Bogenweichenberechnung auf synthetischen Strecken (siehe streckengenerator.hpp)
+// mit 1000, 10000, ... Elementen und einer Bogenweiche pro 100 Elemente:
+//  - Einlesen: LiesStreckendatei
+//  - FindeWeichen: Streckengraph und FindeWeichen (nur Bogenweichen)
+//  - Geometrie: Geometrietabelle
+//  - Zuordnung: BerechneElementZuordnung der abzweigenden Straenge aller Bogenweichen zur unverbogenen Weiche
+//  - Korrektur: BerechneBiegeparameter und KorrigiereKruemmungAbzweigenderStrang fuer alle Bogenweichen
+//  - Schreiben: SchreibeNeueKruemmungen
+// Standardmaessig wird bis 1000000 Elemente gemessen. Eine Strecke braucht etwa 530 Byte Speicher und 240 Byte
+// Streckendatei pro Element, 10 Millionen Elemente also 5,3 GB Speicher und 2,4 GB Platte; die Messung bis dahin
+// ist deshalb nur mit --max 10000000 eingeschaltet.
+// Aufruf: bogenweichen_bench [--max <Elemente>] [--verzeichnis <dir>] [--weichen <weichen.txt>] [--wiederholungen <n>]
+//         bogenweichen_bench --vergleiche [--max <Elemente>] [--verzeichnis <dir>] [--weichen <weichen.txt>]
+//         bogenweichen_bench --erzeuge <dir> <Elemente> <Bogenweichen> [--weichen <weichen.txt>]
+// Die zweite Form misst nicht, sondern vergleicht auf denselben Strecken alle Zwischenergebnisse und die
+// geschriebene Datei mit der skalaren Referenzimplementierung (referenzberechnung.hpp), prueft, dass die erzeugte
+// Strecke keine Knicke hat und durch VerknuepfeNeu unveraendert bleibt, vergleicht auch Knickpruefung und
+// Neuverknuepfung mit der Referenz und endet mit Rueckgabewert 1, wenn eine Abweichung die Schranken unten ueberschreitet.
+// Die dritte Form erzeugt nur eine Testumgebung fuer radius_bogenweichen (Strecke, unverbogene Weichen, LS3-Dateien).
+
+#include "arbeitspool.hpp"
+#include "bogenweichen.hpp"
+#include "geometrietabelle.hpp"
+#include "knickpruefung.hpp"
+#include "kruemmungstabelle.hpp"
+#include "protokoll.hpp"
+#include "referenzberechnung.hpp"
+#include "streckendatei.hpp"
+#include "streckengenerator.hpp"
+#include "streckengraph.hpp"
+#include "verknuepfung.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Fuehrt `f` `wiederholungen` mal aus und gibt die kuerzeste Laufzeit in Sekunden zurueck.
+template<typename F>
+double KuerzesteLaufzeit(int wiederholungen, F&& f) {
+  double result = 0;
+  for (int i = 0; i < wiederholungen; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const double dauer = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result = (i == 0) ? dauer : std::min(result, dauer);
+  }
+  return result;
+}
+
+// Unverbogene Weiche eines Typs, wie sie radius_bogenweichen aus weichen.txt laedt
+struct Originalweiche {
+  std::unique_ptr<Streckendatei> st3;
+  Weiche weiche;
+  Geometrietabelle geometrie;
+};
+
+bool LadeOriginalweiche(const Weichentyp& typ, const std::string& dateiname, Protokoll& log, Originalweiche& ziel) {
+  {
+    std::ofstream ausgabe(dateiname, std::ios::binary);
+    ErzeugeOriginalweiche(ausgabe, typ);
+    if (!ausgabe.flush()) {
+      return false;
+    }
+  }
+  ziel.st3 = LiesStreckendatei(dateiname, Leseoptionen {}, log);
+  std::remove(dateiname.c_str());
+  if (!ziel.st3 || !ziel.st3->zusi->Strecke) {
+    return false;
+  }
+  const auto& strecke = *ziel.st3->zusi->Strecke;
+  auto weichen = FindeWeichen(strecke, Streckengraph(strecke), log);
+  if (weichen.size() != 1) {
+    return false;
+  }
+  ziel.weiche = std::move(weichen[0]);
+  ziel.geometrie = Geometrietabelle(strecke);
+  return true;
+}
+
+// Schreibt die Streckendatei `dateiname` und gibt die Biegekruemmungen der Bogenweichen zurueck (leer bei Fehlern).
+std::vector<double> SchreibeStrecke(const std::string& dateiname, const Generatorparameter& parameter, const std::vector<Weichentyp>& typen) {
+  std::ofstream ausgabe(dateiname, std::ios::binary);
+  auto result = ErzeugeStreckendatei(ausgabe, parameter, typen);
+  if (!ausgabe.flush()) {
+    std::cout << "Fehler beim Schreiben von " << dateiname << "\n";
+    result.clear();
+  }
+  return result;
+}
+
+// Laedt die unverbogenen Weichen aller in der Strecke verwendeten Typen.
+bool LadeOriginalweichen(const Generatorparameter& parameter, const std::vector<Weichentyp>& typen, const std::string& verzeichnis,
+    Protokoll& log, std::map<const Weichentyp*, Originalweiche>& originale) {
+  for (size_t i = 0; i < std::min(parameter.anzahlBogenweichen, typen.size()); ++i) {
+    const auto& typ = TypDerBogenweiche(typen, i);
+    if (!LadeOriginalweiche(typ, verzeichnis + "/bogenweichen_bench_original.st3", log, originale[&typ])) {
+      std::cout << "Fehler beim Laden der unverbogenen Weiche " << typ.originalPfad << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintZeile(size_t anzahlElemente, size_t anzahlBogenweichen, const std::vector<double>& sekunden) {
+  std::cout << std::setw(10) << anzahlElemente << std::setw(8) << anzahlBogenweichen;
+  for (const double dauer : sekunden) {
+    std::cout << std::setw(12) << std::fixed << std::setprecision(2) << (dauer * 1000);
+  }
+  std::cout << std::setw(10) << std::setprecision(0) << (sekunden[0] * 1e9 / anzahlElemente) << "\n";
+}
+
+// Misst alle Schritte fuer eine Strecke mit `anzahlElemente` Elementen. Gibt false bei Fehlern zurueck.
+bool Messe(size_t anzahlElemente, const std::vector<Weichentyp>& typen, const std::string& verzeichnis,
+    int wiederholungen, Arbeitspool& pool) {
+  std::ostringstream meldungen;
+  Protokoll log(meldungen, Ausgabestufe::Fehler);
+
+  Generatorparameter parameter;
+  parameter.anzahlElemente = anzahlElemente;
+  parameter.anzahlBogenweichen = std::max<size_t>(1, anzahlElemente / 100);
+  const std::string dateiname = verzeichnis + "/bogenweichen_bench_" + std::to_string(anzahlElemente) + ".st3";
+  if (SchreibeStrecke(dateiname, parameter, typen).empty()) {
+    return false;
+  }
+
+  std::map<const Weichentyp*, Originalweiche> originale;
+  if (!LadeOriginalweichen(parameter, typen, verzeichnis, log, originale)) {
+    std::cout << meldungen.str();
+    return false;
+  }
+
+  std::vector<double> sekunden;
+  std::unique_ptr<Streckendatei> datei;
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    datei = LiesStreckendatei(dateiname, Leseoptionen {}, pool, log);
+  }));
+  if (!datei || !datei->zusi->Strecke) {
+    std::cout << "Fehler beim Einlesen von " << dateiname << "\n" << meldungen.str();
+    return false;
+  }
+  const auto& strecke = *datei->zusi->Strecke;
+
+  std::vector<Weiche> bogenweichen;
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    bogenweichen = FindeWeichen(strecke, Streckengraph(strecke), log, true);
+  }));
+  if (bogenweichen.size() != parameter.anzahlBogenweichen) {
+    std::cout << bogenweichen.size() << " statt " << parameter.anzahlBogenweichen << " Bogenweichen gefunden\n" << meldungen.str();
+    return false;
+  }
+
+  Geometrietabelle geometrie;
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    geometrie = Geometrietabelle(strecke, pool);
+  }));
+
+  // Die Bogenweichen werden wie in radius_bogenweichen parallel bearbeitet
+  std::vector<std::vector<size_t>> zuordnungen(bogenweichen.size());
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    pool.ParallelFuer(bogenweichen.size(), [&](size_t i) {
+      const auto& original = originale.at(&TypDerBogenweiche(typen, i));
+      zuordnungen[i] = BerechneElementZuordnung(bogenweichen[i].abzweigenderStrang, geometrie,
+          original.weiche.abzweigenderStrang, original.geometrie);
+    });
+  }));
+
+  std::vector<std::vector<std::pair<std::size_t, double>>> kruemmungen(bogenweichen.size());
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    pool.ParallelFuer(bogenweichen.size(), [&](size_t i) {
+      const auto& original = originale.at(&TypDerBogenweiche(typen, i));
+      const auto& bogenweiche = bogenweichen[i];
+      std::ostringstream weichenmeldungen;
+      Protokoll weichenlog(weichenmeldungen, Ausgabestufe::Zusammenfassung);
+      const auto& biegeparameter = BerechneBiegeparameter(original.weiche.geraderStrang, original.geometrie,
+          bogenweiche.geraderStrang, geometrie, weichenlog);
+      kruemmungen[i] = KorrigiereKruemmungAbzweigenderStrang(original.weiche.startElement, bogenweiche.startElement,
+          original.weiche.abzweigenderStrang, bogenweiche.abzweigenderStrang, original.geometrie, geometrie,
+          biegeparameter, weichenlog);
+    });
+  }));
+
+  Kruemmungstabelle kruemmungenNeu(strecke.children_StrElement.size());
+  for (const auto& weichenkruemmungen : kruemmungen) {
+    for (const auto& [nr, kr] : weichenkruemmungen) {
+      kruemmungenNeu.Setze(nr, kr);
+    }
+  }
+  const std::string dateinameNeu = dateiname + ".new.st3";
+  bool geschrieben = true;
+  sekunden.push_back(KuerzesteLaufzeit(wiederholungen, [&]() {
+    geschrieben = SchreibeNeueKruemmungen(*datei, dateinameNeu, kruemmungenNeu, log) && geschrieben;
+  }));
+
+  datei.reset();
+  std::remove(dateinameNeu.c_str());
+  std::remove(dateiname.c_str());
+  if (!geschrieben) {
+    std::cout << "Fehler beim Schreiben von " << dateinameNeu << "\n";
+    return false;
+  }
+
+  PrintZeile(anzahlElemente, bogenweichen.size(), sekunden);
+  return true;
+}
+
+// Schranken fuer --vergleiche: erlaubte Abweichung der optimierten Implementierung von der Referenz.
+// Die Referenz rechnet wie das Original std::hypot mit float-Argumenten, Laengen sind dort also nur auf float-Genauigkeit
+// bestimmt; die Schranken fuer alles, was von Laengen abhaengt, sind entsprechend in float-ulp bzw. daraus abgeleitet.
+constexpr uint64_t MAX_ULP_LAENGE = 2;           // Elementlaengen, in float-ulp: std::hypot mit drei float-Argumenten rechnet in float
+constexpr double MAX_WINKELFEHLER = 1e-8;        // rad: Tangentenwinkel asin(l*kr/2) mit float-genauer Laenge (kr <= 0.1/m)
+constexpr uint64_t MAX_ULP_KRUEMMUNG = 2;        // Biegeparameter aus dem geraden Strang und neue Kruemmungen
+constexpr uint64_t MAX_ULP_LS3 = 1;              // Biegeparameter aus der LS3-Beschreibung, in float-ulp (Referenz liest mit std::stof)
+constexpr double MAX_LAUFLAENGENFEHLER = 1e-4;   // m, Lauflaengen der Biegeparameter (Summen float-genauer Elementlaengen)
+constexpr uint64_t MAX_ULP_GESCHRIEBEN = 0;      // geschriebene gegenueber berechneter Kruemmung, in float-ulp (Typ von StrElement::kr)
+constexpr double MAX_KNICK_GRAD = 0.1;           // Stoesse der erzeugten Strecke, nur durch die Rundung der Koordinaten auf float
+constexpr double MAX_KNICKFEHLER = 2 * MAX_WINKELFEHLER;  // rad, Knick als Differenz zweier Winkel
+constexpr double TOLERANZ_VERKNUEPFUNG = 0.01;   // m, Standardwert von radius_bogenweichen --verknuepfen
+
+// Abstand zweier Gleitkommazahlen in Einheiten der letzten Stelle, 0 bei Gleichheit (auch fuer +0 und -0)
+template<typename T, typename Bits>
+uint64_t UlpAbstand(T a, T b) {
+  static_assert(sizeof(T) == sizeof(Bits), "");
+  if (a == b) {
+    return 0;
+  }
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  // Bitmuster so umordnen, dass sie als vorzeichenlose Zahlen wie die Gleitkommazahlen sortiert sind
+  const auto geordnet = [](T x) -> Bits {
+    Bits bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    constexpr Bits vorzeichen = Bits { 1 } << (8 * sizeof(Bits) - 1);
+    return (bits & vorzeichen) ? Bits(~bits) : Bits(bits | vorzeichen);
+  };
+  const Bits ga = geordnet(a);
+  const Bits gb = geordnet(b);
+  return ga > gb ? ga - gb : gb - ga;
+}
+
+// Betrag der Differenz zweier Richtungswinkel, die auch ausserhalb von [-π, π] liegen duerfen
+double Winkelabstand(double phi1, double phi2) {
+  return std::abs(std::remainder(phi1 - phi2, 2 * M_PI));
+}
+
+// Groesste Abweichungen von der Referenz. Verstoesse gegen die Schranken werden gezaehlt,
+// die ersten davon mit Elementnummer gemeldet.
+class Vergleich {
+ public:
+  explicit Vergleich(std::ostream& meldungen) : m_meldungen(meldungen) {}
+
+  size_t anzahlFehler() const { return m_anzahlFehler; }
+
+  uint64_t maxUlpLaenge = 0;
+  double maxWinkelfehler = 0;
+  uint64_t maxUlpKruemmung = 0;
+  uint64_t maxUlpLS3 = 0;
+  uint64_t maxUlpGeschrieben = 0;
+
+  // Meldet eine Abweichung, die keine Schranke hat (z.B. unterschiedliche Elementzuordnung).
+  std::ostream& Fehler(const char* was, size_t nr) {
+    ++m_anzahlFehler;
+    if (m_anzahlFehler > 20) {
+      return m_verworfen;
+    }
+    return m_meldungen << "  ! " << was << ", Element " << nr << ": ";
+  }
+
+  void Ulp(const char* was, size_t nr, double wert, double referenz, uint64_t schranke, uint64_t& maximum) {
+    const uint64_t ulp = UlpAbstand<double, uint64_t>(wert, referenz);
+    maximum = std::max(maximum, ulp);
+    if (ulp > schranke) {
+      Fehler(was, nr) << std::setprecision(17) << wert << " statt " << referenz << " (" << ulp << " ulp)\n";
+    }
+  }
+
+  void UlpFloat(const char* was, size_t nr, double wert, double referenz, uint64_t schranke, uint64_t& maximum) {
+    const uint64_t ulp = UlpAbstand<float, uint32_t>(static_cast<float>(wert), static_cast<float>(referenz));
+    maximum = std::max(maximum, ulp);
+    if (ulp > schranke) {
+      Fehler(was, nr) << std::setprecision(9) << wert << " statt " << referenz << " (" << ulp << " float-ulp)\n";
+    }
+  }
+
+  // Abweichung in float-ulp von `bezug`, fuer Werte, die durch Ausloeschung kleiner als ihr Fehlerbezug sein koennen
+  void UlpBezogen(const char* was, size_t nr, double wert, double referenz, double bezug, uint64_t schranke, uint64_t& maximum) {
+    const float b = std::abs(static_cast<float>(bezug));
+    const double ulpBezug = std::nextafter(b, std::numeric_limits<float>::infinity()) - b;
+    const uint64_t ulp = static_cast<uint64_t>(std::ceil(std::abs(wert - referenz) / ulpBezug));
+    maximum = std::max(maximum, ulp);
+    if (ulp > schranke) {
+      Fehler(was, nr) << std::setprecision(17) << wert << " statt " << referenz << " (" << ulp << " float-ulp von " << bezug << ")\n";
+    }
+  }
+
+  void Absolut(const char* was, size_t nr, double abweichung, double schranke, double& maximum) {
+    maximum = std::max(maximum, abweichung);
+    if (!(abweichung <= schranke)) {
+      Fehler(was, nr) << std::setprecision(3) << abweichung << " > " << schranke << "\n";
+    }
+  }
+
+ private:
+  std::ostream& m_meldungen;
+  std::ostringstream m_verworfen;
+  size_t m_anzahlFehler = 0;
+};
+
+// Vergleicht Laengen und Winkel (alle drei Varianten von GetWinkel) aller Elemente der Strecke mit der Referenz.
+void VergleicheGeometrie(const Strecke& strecke, const Geometrietabelle& geometrie, Vergleich& vergleich) {
+  for (size_t nr = 0; nr < strecke.children_StrElement.size(); ++nr) {
+    const auto& el = strecke.children_StrElement[nr];
+    if (!el) {
+      continue;
+    }
+    vergleich.UlpFloat("Laenge", nr, geometrie.laenge(nr), referenz::ElementLaenge(*el), MAX_ULP_LAENGE, vergleich.maxUlpLaenge);
+    for (const bool norm : { true, false }) {
+      for (const auto ende : { ElementEnde::Anfang, ElementEnde::Ende }) {
+        const ElementUndRichtung er { el.get(), norm };
+        const double winkelReferenz = referenz::GetWinkel(er, ende);
+        vergleich.Absolut("Winkel", nr, Winkelabstand(GetWinkel(geometrie, er, ende), winkelReferenz),
+            MAX_WINKELFEHLER, vergleich.maxWinkelfehler);
+        vergleich.Absolut("Winkel (Geometrietabelle)", nr, Winkelabstand(GetWinkel(geometrie, MitRichtung(nr, norm), ende), winkelReferenz),
+            MAX_WINKELFEHLER, vergleich.maxWinkelfehler);
+      }
+    }
+  }
+}
+
+// Vergleicht den Knick an allen Stoessen (FindeKnicke) mit der Referenz und meldet Knicke ueber MAX_KNICK_GRAD.
+// Gibt den groessten Knick in Grad zurueck, `anzahlStoesse` enthaelt danach die Anzahl der Stoesse.
+double VergleicheKnicke(const Strecke& strecke, const Geometrietabelle& geometrie, Arbeitspool& pool, Vergleich& vergleich,
+    size_t& anzahlStoesse) {
+  auto stoesse = FindeKnicke(Streckengraph(strecke), geometrie, -1, pool, anzahlStoesse);
+  const double groessterKnick = stoesse.empty() ? 0 : stoesse.front().knick * 180.0 / M_PI;
+  for (const auto& stoss : stoesse) {
+    if (stoss.knick * 180.0 / M_PI <= MAX_KNICK_GRAD) {
+      break;
+    }
+    vergleich.Fehler("Knick am Stoss", Nummer(stoss.element)) << (stoss.knick * 180.0 / M_PI) << " Grad zu Element "
+      << Nummer(stoss.nachfolger) << (Normrichtung(stoss.nachfolger) ? " (Norm)" : " (Gegen)") << "\n";
+  }
+
+  auto referenzStoesse = referenz::FindeKnicke(strecke);
+  if (stoesse.size() != referenzStoesse.size()) {
+    vergleich.Fehler("Anzahl Stoesse mit Knick", 0) << stoesse.size() << " statt " << referenzStoesse.size() << "\n";
+    return groessterKnick;
+  }
+  const auto nachElement = [](const auto& a, const auto& b) {
+    return std::make_pair(a.element, a.nachfolger) < std::make_pair(b.element, b.nachfolger);
+  };
+  std::sort(stoesse.begin(), stoesse.end(), nachElement);
+  std::sort(referenzStoesse.begin(), referenzStoesse.end(), nachElement);
+  for (size_t i = 0; i < stoesse.size(); ++i) {
+    if (stoesse[i].element != referenzStoesse[i].element || stoesse[i].nachfolger != referenzStoesse[i].nachfolger) {
+      vergleich.Fehler("Stoss", Nummer(stoesse[i].element)) << "zu Element " << Nummer(stoesse[i].nachfolger) << " statt Element "
+        << Nummer(referenzStoesse[i].element) << " zu " << Nummer(referenzStoesse[i].nachfolger) << "\n";
+      continue;
+    }
+    vergleich.Absolut("Knick", Nummer(stoesse[i].element), std::abs(stoesse[i].knick - referenzStoesse[i].knick),
+        MAX_KNICKFEHLER, vergleich.maxWinkelfehler);
+  }
+  return groessterKnick;
+}
+
+// Vergleicht children_NachNorm, children_NachGegen und die Anschluss-Bits aller Elemente mit den Nachfolgern aus
+// referenz::Nachfolger.
+void VergleicheVerknuepfung(const Strecke& strecke, const std::vector<std::vector<std::pair<size_t, bool>>>& referenzNachfolger,
+    Vergleich& vergleich) {
+  for (size_t nr = 0; nr < strecke.children_StrElement.size(); ++nr) {
+    const auto& el = strecke.children_StrElement[nr];
+    if (!el) {
+      continue;
+    }
+    for (const bool norm : { true, false }) {
+      const auto& nachfolger = norm ? el->children_NachNorm : el->children_NachGegen;
+      const auto& referenzliste = referenzNachfolger[2 * nr + (norm ? 1 : 0)];
+      bool gleich = (nachfolger.size() == referenzliste.size());
+      for (size_t i = 0; gleich && i < nachfolger.size(); ++i) {
+        const bool anEndeB = (el->Anschluss & ((norm ? 0x1 : 0x100) << i)) != 0;
+        gleich = (static_cast<size_t>(nachfolger[i].Nr) == referenzliste[i].first && anEndeB == referenzliste[i].second);
+      }
+      if (!gleich) {
+        vergleich.Fehler(norm ? "Nachfolger in Normrichtung" : "Nachfolger in Gegenrichtung", nr) << nachfolger.size()
+          << " Nachfolger statt " << referenzliste.size() << "\n";
+      }
+    }
+  }
+}
+
+void VergleicheBiegeparameter(const std::vector<std::pair<double, double>>& werte, const std::vector<std::pair<double, double>>& referenzwerte,
+    bool ausLS3, size_t nr, Vergleich& vergleich) {
+  if (werte.size() != referenzwerte.size()) {
+    vergleich.Fehler("Anzahl Biegeparameter", nr) << werte.size() << " statt " << referenzwerte.size() << "\n";
+    return;
+  }
+  double maxLauflaengenfehler = 0;
+  for (size_t i = 0; i < werte.size(); ++i) {
+    vergleich.Absolut("Lauflaenge Biegeparameter", nr, std::abs(werte[i].first - referenzwerte[i].first),
+        MAX_LAUFLAENGENFEHLER, maxLauflaengenfehler);
+    if (ausLS3) {
+      vergleich.UlpFloat("Biegeparameter LS3", nr, werte[i].second, referenzwerte[i].second, MAX_ULP_LS3, vergleich.maxUlpLS3);
+    } else {
+      vergleich.Ulp("Biegeparameter", nr, werte[i].second, referenzwerte[i].second, MAX_ULP_KRUEMMUNG, vergleich.maxUlpKruemmung);
+    }
+  }
+}
+
+// Prueft die geschriebene Datei gegen die Eingabe: Ausserhalb der kr-Attribute der Elemente aus `kruemmungenNeu`
+// muss sie Byte fuer Byte gleich sein (fehlende Attribute werden als ` kr="..."` eingefuegt), und die geschriebenen
+// Kruemmungen muessen beim Einlesen die Werte aus `kruemmungenNeu` ergeben.
+void VergleicheAusgabe(const Streckendatei& eingabe, const Streckendatei& ausgabe, const Kruemmungstabelle& kruemmungenNeu,
+    Vergleich& vergleich) {
+  const auto& elemente = eingabe.zusi->Strecke->children_StrElement;
+  if (ausgabe.krPositionen.size() != eingabe.krPositionen.size()) {
+    vergleich.Fehler("Anzahl Elemente in geschriebener Datei", ausgabe.krPositionen.size()) << "statt " << eingabe.krPositionen.size() << "\n";
+    return;
+  }
+  std::vector<size_t> reihenfolge;
+  for (size_t nr = 0; nr < elemente.size(); ++nr) {
+    if (elemente[nr]) {
+      reihenfolge.push_back(nr);
+    }
+  }
+  std::sort(reihenfolge.begin(), reihenfolge.end(), [&eingabe](size_t lhs, size_t rhs) {
+    return eingabe.krPositionen[lhs].anfang < eingabe.krPositionen[rhs].anfang;
+  });
+
+  const std::string_view textEingabe(eingabe.inhalt.data(), eingabe.inhalt.size());
+  const std::string_view textAusgabe(ausgabe.inhalt.data(), ausgabe.inhalt.size());
+  size_t posEingabe = 0;
+  size_t posAusgabe = 0;
+  std::string erwartet;
+  for (const size_t nr : reihenfolge) {
+    const auto& krEingabe = eingabe.krPositionen[nr];
+    const auto& krAusgabe = ausgabe.krPositionen[nr];
+    const bool korrigiert = kruemmungenNeu.gesetzt(nr);
+    const bool eingefuegt = korrigiert && !krEingabe.vorhanden;
+
+    erwartet.assign(textEingabe.substr(posEingabe, krEingabe.anfang - posEingabe));
+    if (eingefuegt) {
+      erwartet += " kr=\"";
+    }
+    if (krAusgabe.anfang < posAusgabe || textAusgabe.substr(posAusgabe, krAusgabe.anfang - posAusgabe) != erwartet
+        || (eingefuegt && textAusgabe.substr(krAusgabe.ende, 1) != "\"")) {
+      vergleich.Fehler("Geschriebene Datei weicht ausserhalb von kr ab", nr) << "\n";
+      return;
+    }
+
+    const auto wertEingabe = textEingabe.substr(krEingabe.anfang, krEingabe.ende - krEingabe.anfang);
+    const auto wertAusgabe = textAusgabe.substr(krAusgabe.anfang, krAusgabe.ende - krAusgabe.anfang);
+    if (!korrigiert) {
+      if (wertAusgabe != wertEingabe) {
+        vergleich.Fehler("Nicht korrigiertes Element geaendert", nr) << wertEingabe << " -> " << wertAusgabe << "\n";
+      }
+    } else {
+      const std::string wert(wertAusgabe);
+      char* ende = nullptr;
+      const float kr = std::strtof(wert.c_str(), &ende);
+      if (wert.empty() || ende != wert.c_str() + wert.size()) {
+        vergleich.Fehler("Geschriebene Kruemmung nicht lesbar", nr) << wert << "\n";
+      } else {
+        vergleich.UlpFloat("Geschriebene Kruemmung", nr, kr, kruemmungenNeu.wert(nr), MAX_ULP_GESCHRIEBEN, vergleich.maxUlpGeschrieben);
+      }
+    }
+    posEingabe = krEingabe.ende;
+    posAusgabe = krAusgabe.ende + (eingefuegt ? 1 : 0);
+  }
+  if (textAusgabe.substr(posAusgabe) != textEingabe.substr(posEingabe)) {
+    vergleich.Fehler("Geschriebene Datei weicht nach dem letzten Element ab", 0) << "\n";
+  }
+}
+
+// Vergleicht LiesBiegeparameter auf Dateibeschreibungen, die der Generator nicht erzeugt (Dezimalpunkt,
+// Leerzeichen, Exponent, unlesbare Werte), mit der Referenz. Nicht lesbare Beschreibungen ergeben in beiden
+// Implementierungen keine Biegeparameter, die optimierte muss zusaetzlich die Fehlerstelle angeben.
+void VergleicheBeschreibungen(Vergleich& vergleich) {
+  struct Fall {
+    const char* beschreibung;
+    size_t fehlerposition;  // SIZE_MAX: lesbar
+  };
+  constexpr size_t LESBAR = SIZE_MAX;
+  const Fall faelle[] = {
+    { "l=3 kr=0.000667 l=16 kr=0.0006 l=16 kr=0.000733", LESBAR },
+    { "Bogenweiche l=3,0 kr=-1,5e-4 l=16,5 kr=-0,00012", LESBAR },
+    { "l= 3  kr= +0,001 l=8\tkr=0,002", LESBAR },
+    { "kr=0,001 l=4 kr=0,002", LESBAR },
+    { "Winkel=2 kr=0,001", LESBAR },
+    { "Bogenweiche ohne Parameter", LESBAR },
+    { "l=3 kr=0,001 l=x kr=0,002", 15 },
+    { "l=3 kr=abc", 7 },
+  };
+  std::ostringstream meldungen;
+  Protokoll log(meldungen, Ausgabestufe::Zusammenfassung);
+  for (size_t i = 0; i < std::size(faelle); ++i) {
+    const auto& fall = faelle[i];
+    for (const double offset : { 0.0, 3.0 }) {
+      std::vector<std::pair<double, double>> werte;
+      Lesefehler fehler;
+      const bool gelesen = LiesBiegeparameter(fall.beschreibung, offset, werte, fehler, log);
+      if (gelesen != (fall.fehlerposition == LESBAR) || (!gelesen && fehler.position != fall.fehlerposition)) {
+        vergleich.Fehler("Dateibeschreibung", i) << "\"" << fall.beschreibung << "\": "
+          << (gelesen ? std::string("gelesen") : "Fehler an Position " + std::to_string(fehler.position)) << "\n";
+      }
+      if (!gelesen) {
+        werte.clear();
+      }
+      VergleicheBiegeparameter(werte, referenz::LiesBiegeparameter(fall.beschreibung, offset), true, i, vergleich);
+    }
+  }
+}
+
+// Berechnet eine Strecke mit `anzahlElemente` Elementen mit der optimierten und der Referenzimplementierung
+// und vergleicht alle Zwischenergebnisse. Gibt false zurueck, wenn eine Schranke verletzt ist oder ein Fehler auftritt.
+bool Vergleiche(size_t anzahlElemente, const std::vector<Weichentyp>& typen, const std::string& verzeichnis, Arbeitspool& pool) {
+  std::ostringstream meldungen;
+  Protokoll log(meldungen, Ausgabestufe::Fehler);
+
+  Generatorparameter parameter;
+  parameter.anzahlElemente = anzahlElemente;
+  parameter.anzahlBogenweichen = std::max<size_t>(1, anzahlElemente / 100);
+  parameter.startwert = static_cast<unsigned int>(anzahlElemente);
+  const std::string dateiname = verzeichnis + "/bogenweichen_bench_" + std::to_string(anzahlElemente) + ".st3";
+  const std::string dateinameNeu = dateiname + ".new.st3";
+  const auto& biegungen = SchreibeStrecke(dateiname, parameter, typen);
+  if (biegungen.empty()) {
+    return false;
+  }
+
+  std::map<const Weichentyp*, Originalweiche> originale;
+  if (!LadeOriginalweichen(parameter, typen, verzeichnis, log, originale)) {
+    std::cout << meldungen.str();
+    return false;
+  }
+
+  const auto datei = LiesStreckendatei(dateiname, Leseoptionen {}, pool, log);
+  if (!datei || !datei->zusi->Strecke) {
+    std::cout << "Fehler beim Einlesen von " << dateiname << "\n" << meldungen.str();
+    return false;
+  }
+  const auto& strecke = *datei->zusi->Strecke;
+  const auto& bogenweichen = FindeWeichen(strecke, Streckengraph(strecke), log, true);
+  if (bogenweichen.size() != biegungen.size()) {
+    std::cout << bogenweichen.size() << " statt " << biegungen.size() << " Bogenweichen gefunden\n" << meldungen.str();
+    return false;
+  }
+  const Geometrietabelle geometrie(strecke, pool);
+
+  std::ostringstream abweichungen;
+  Vergleich vergleich(abweichungen);
+  VergleicheGeometrie(strecke, geometrie, vergleich);
+  for (const auto& [typ, original] : originale) {
+    VergleicheGeometrie(*original.st3->zusi->Strecke, original.geometrie, vergleich);
+  }
+
+  // Jeder Stoss ist in beiden Richtungen verknuepft und wird deshalb nur einmal gezaehlt
+  size_t anzahlStoesse = 0;
+  const double groessterKnick = VergleicheKnicke(strecke, geometrie, pool, vergleich, anzahlStoesse);
+  if (anzahlStoesse != parameter.anzahlElemente - 1) {
+    vergleich.Fehler("Anzahl Stoesse", 0) << anzahlStoesse << " statt " << (parameter.anzahlElemente - 1) << "\n";
+  }
+
+  // Wie in radius_bogenweichen: Biegeparameter aus der LS3-Datei, wenn vorhanden (hier jede zweite Bogenweiche),
+  // sonst aus dem geraden Strang
+  Kruemmungstabelle kruemmungenNeu(strecke.children_StrElement.size());
+  std::map<size_t, double> referenzKruemmungen;
+  for (size_t i = 0; i < bogenweichen.size(); ++i) {
+    const auto& weiche = originale.at(&TypDerBogenweiche(typen, i)).weiche;
+    const auto& originalGeometrie = originale.at(&TypDerBogenweiche(typen, i)).geometrie;
+    const auto& bogenweiche = bogenweichen[i];
+    const size_t nr = bogenweiche.startElement.first->Nr;
+    std::ostringstream weichenmeldungen;
+    Protokoll weichenlog(weichenmeldungen, Ausgabestufe::Zusammenfassung);
+
+    if (BerechneElementZuordnung(bogenweiche.abzweigenderStrang, geometrie, weiche.abzweigenderStrang, originalGeometrie)
+        != referenz::BerechneElementZuordnung(bogenweiche.abzweigenderStrang, weiche.abzweigenderStrang)) {
+      vergleich.Fehler("Elementzuordnung des abzweigenden Strangs", nr) << "\n";
+    }
+
+    std::vector<std::pair<double, double>> biegeparameter;
+    std::vector<std::pair<double, double>> referenzBiegeparameter;
+    const bool ausLS3 = (i % 2 == 0);
+    if (ausLS3) {
+      Zusi ls3;
+      ls3.Info = std::make_unique<Info>();
+      ls3.Info->Beschreibung = BeschreibungVerbogeneLS3(biegungen[i]);
+      biegeparameter = LiesBiegeparameter(ls3, originalGeometrie.laenge(weiche.startElement.first->Nr), weichenlog);
+      referenzBiegeparameter = referenz::LiesBiegeparameter(ls3.Info->Beschreibung, referenz::ElementLaenge(*weiche.startElement.first));
+    } else {
+      biegeparameter = BerechneBiegeparameter(weiche.geraderStrang, originalGeometrie, bogenweiche.geraderStrang, geometrie, weichenlog);
+      referenzBiegeparameter = referenz::BerechneBiegeparameter(weiche.geraderStrang, bogenweiche.geraderStrang);
+    }
+    VergleicheBiegeparameter(biegeparameter, referenzBiegeparameter, ausLS3, nr, vergleich);
+    if (biegeparameter.empty() || referenzBiegeparameter.empty()) {
+      vergleich.Fehler("Keine Biegeparameter", nr) << "\n";
+      continue;
+    }
+
+    const auto& neu = KorrigiereKruemmungAbzweigenderStrang(weiche.startElement, bogenweiche.startElement,
+        weiche.abzweigenderStrang, bogenweiche.abzweigenderStrang, originalGeometrie, geometrie, biegeparameter, weichenlog);
+    const auto& referenzNeu = referenz::KorrigiereKruemmungAbzweigenderStrang(weiche.abzweigenderStrang, bogenweiche.abzweigenderStrang,
+        referenzBiegeparameter);
+    // Die Referenz liest die LS3-Beschreibung mit std::stof, die Kruemmungsdifferenzen sind dort also nur auf 1/2 float-ulp
+    // genau. Die neue Kruemmung (unverbogene Kruemmung + Differenz) kann durch Ausloeschung kleiner als die Differenz sein,
+    // deshalb wird ihr Fehler in float-ulp der betragsmaessig groessten Differenz gemessen.
+    double groessteKruemmungsdifferenz = 0;
+    for (const auto& [lauflaenge, krdiff] : referenzBiegeparameter) {
+      groessteKruemmungsdifferenz = std::max(groessteKruemmungsdifferenz, std::abs(krdiff));
+    }
+    if (neu.size() != referenzNeu.size()) {
+      vergleich.Fehler("Anzahl korrigierter Elemente", nr) << neu.size() << " statt " << referenzNeu.size() << "\n";
+      continue;
+    }
+    for (size_t j = 0; j < neu.size(); ++j) {
+      if (neu[j].first != referenzNeu[j].first) {
+        vergleich.Fehler("Korrigiertes Element", neu[j].first) << "statt " << referenzNeu[j].first << "\n";
+        continue;
+      }
+      if (ausLS3) {
+        vergleich.UlpBezogen("Neue Kruemmung (LS3)", neu[j].first, neu[j].second, referenzNeu[j].second, groessteKruemmungsdifferenz,
+            MAX_ULP_LS3, vergleich.maxUlpLS3);
+      } else {
+        vergleich.Ulp("Neue Kruemmung", neu[j].first, neu[j].second, referenzNeu[j].second, MAX_ULP_KRUEMMUNG, vergleich.maxUlpKruemmung);
+      }
+      // Winkel mit der neuen Kruemmung, wie fuer die Knickwinkel in KorrigiereKruemmungAbzweigenderStrang
+      const auto& el = bogenweiche.abzweigenderStrang[j];
+      for (const auto ende : { ElementEnde::Anfang, ElementEnde::Ende }) {
+        vergleich.Absolut("Winkel mit neuer Kruemmung", neu[j].first,
+            Winkelabstand(GetWinkel(geometrie, el, ende, neu[j].second), referenz::GetWinkel(el, ende, referenzNeu[j].second)),
+            MAX_WINKELFEHLER, vergleich.maxWinkelfehler);
+      }
+      kruemmungenNeu.Setze(neu[j].first, neu[j].second);
+      referenzKruemmungen.emplace(referenzNeu[j].first, referenzNeu[j].second);
+    }
+  }
+
+  // Dieselben Elemente muessen korrigiert werden
+  size_t anzahlGeaendert = 0;
+  kruemmungenNeu.FuerAlleGesetzten([&](size_t nr, double) {
+    ++anzahlGeaendert;
+    if (referenzKruemmungen.count(nr) == 0) {
+      vergleich.Fehler("Element nur von der optimierten Implementierung korrigiert", nr) << "\n";
+    }
+  });
+  if (anzahlGeaendert != referenzKruemmungen.size()) {
+    vergleich.Fehler("Anzahl korrigierter Elemente", 0) << anzahlGeaendert << " statt " << referenzKruemmungen.size() << "\n";
+  }
+
+  bool ok = SchreibeNeueKruemmungen(*datei, dateinameNeu, kruemmungenNeu, log);
+  if (ok) {
+    const auto geschrieben = LiesStreckendatei(dateinameNeu, Leseoptionen {}, log);
+    ok = geschrieben && geschrieben->zusi->Strecke;
+    if (ok) {
+      VergleicheAusgabe(*datei, *geschrieben, kruemmungenNeu, vergleich);
+    }
+  }
+  std::remove(dateinameNeu.c_str());
+  std::remove(dateiname.c_str());
+
+  // Die erzeugte Strecke ist richtig verknuepft, geometrisches Neuverknuepfen darf nichts aendern.
+  // Ohne Verknuepfungen muss VerknuepfeNeu alle Elemente wie die Referenz verknuepfen.
+  auto& streckeVerknuepft = *datei->zusi->Strecke;
+  const size_t anzahlNeuVerknuepft = VerknuepfeNeu(streckeVerknuepft, TOLERANZ_VERKNUEPFUNG, pool);
+  if (anzahlNeuVerknuepft != 0) {
+    vergleich.Fehler("Verknuepfung durch VerknuepfeNeu geaendert", 0) << anzahlNeuVerknuepft << " Elemente\n";
+  }
+  const auto& referenzNachfolger = referenz::Nachfolger(streckeVerknuepft, TOLERANZ_VERKNUEPFUNG);
+  VergleicheVerknuepfung(streckeVerknuepft, referenzNachfolger, vergleich);
+  for (auto& el : streckeVerknuepft.children_StrElement) {
+    if (el) {
+      el->children_NachNorm.clear();
+      el->children_NachGegen.clear();
+      el->Anschluss = 0;
+    }
+  }
+  const size_t anzahlVerknuepft = VerknuepfeNeu(streckeVerknuepft, TOLERANZ_VERKNUEPFUNG, pool);
+  if (anzahlVerknuepft != parameter.anzahlElemente) {
+    vergleich.Fehler("Anzahl durch VerknuepfeNeu verknuepfter Elemente", 0) << anzahlVerknuepft << " statt "
+      << parameter.anzahlElemente << "\n";
+  }
+  VergleicheVerknuepfung(streckeVerknuepft, referenzNachfolger, vergleich);
+
+  if (!ok) {
+    std::cout << "Fehler beim Schreiben oder Einlesen von " << dateinameNeu << "\n" << meldungen.str();
+    return false;
+  }
+
+  std::cout << std::setw(10) << anzahlElemente << std::setw(8) << bogenweichen.size() << std::setw(11) << anzahlGeaendert
+    << std::setw(9) << vergleich.maxUlpLaenge << std::setw(12) << std::setprecision(2) << std::scientific << vergleich.maxWinkelfehler
+    << std::setw(8) << vergleich.maxUlpKruemmung << std::setw(8) << vergleich.maxUlpLS3
+    << std::defaultfloat << std::setw(12) << vergleich.maxUlpGeschrieben << std::setw(8) << std::setprecision(2) << groessterKnick
+    << std::setw(8) << anzahlNeuVerknuepft
+    << "  " << (vergleich.anzahlFehler() == 0 ? "ok" : std::to_string(vergleich.anzahlFehler()) + " Fehler") << "\n";
+  std::cout << abweichungen.str();
+  return vergleich.anzahlFehler() == 0;
+}
+
+void PrintUsage(const char* programm) {
+  std::cout << "Aufruf: " << programm << " [--max <Elemente>] [--verzeichnis <dir>] [--weichen <weichen.txt>] [--wiederholungen <n>]\n"
+    << "       " << programm << " --vergleiche [--max <Elemente>] [--verzeichnis <dir>] [--weichen <weichen.txt>]\n"
+    << "       " << programm << " --erzeuge <dir> <Elemente> <Bogenweichen> [--weichen <weichen.txt>]\n"
+    << "  --max <n>            Groesste gemessene Strecke (Standard: 1000000, Schritte 1000, 10000, ...). --max 10000000\n"
+    << "                       misst auch 10 Millionen Elemente, braucht dafuer aber etwa 5,3 GB Speicher und 2,4 GB Platte\n"
+    << "  --verzeichnis <dir>  Verzeichnis fuer die temporaeren Streckendateien (Standard: .)\n"
+    << "  --weichen <datei>    Weichentypen (Standard: weichen.txt)\n"
+    << "  --wiederholungen <n> Jede Messung n-mal ausfuehren und die kuerzeste Laufzeit ausgeben (Standard: 3)\n"
+    << "  --vergleiche         Statt zu messen mit der skalaren Referenzimplementierung vergleichen\n"
+    << "  --erzeuge            Nur eine Testumgebung fuer radius_bogenweichen unter <dir> erzeugen\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t maxElemente = 1000000;
+  std::string verzeichnis = ".";
+  std::string weichenDatei = "weichen.txt";
+  int wiederholungen = 3;
+  std::vector<std::string> erzeuge;
+  bool vergleiche = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg(argv[i]);
+    const int anzahlWerte = (arg == "--erzeuge") ? 3 : (arg == "--max" || arg == "--verzeichnis" || arg == "--weichen" || arg == "--wiederholungen") ? 1 : 0;
+    if (i + anzahlWerte >= argc) {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    if (arg == "--max") {
+      maxElemente = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--verzeichnis") {
+      verzeichnis = argv[++i];
+    } else if (arg == "--weichen") {
+      weichenDatei = argv[++i];
+    } else if (arg == "--wiederholungen") {
+      wiederholungen = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--vergleiche") {
+      vergleiche = true;
+    } else if (arg == "--erzeuge") {
+      erzeuge.assign(argv + i + 1, argv + i + 4);
+      i += 3;
+    } else {
+      PrintUsage(argv[0]);
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+
+  const auto& typen = LiesWeichentypen(weichenDatei);
+  if (typen.empty()) {
+    std::cout << "Keine Weichentypen in " << weichenDatei << "\n";
+    return 1;
+  }
+
+  if (!erzeuge.empty()) {
+    Generatorparameter parameter;
+    parameter.anzahlElemente = std::strtoull(erzeuge[1].c_str(), nullptr, 10);
+    parameter.anzahlBogenweichen = std::strtoull(erzeuge[2].c_str(), nullptr, 10);
+    if (!ErzeugeTestumgebung(erzeuge[0], parameter, typen)) {
+      std::cout << "Fehler beim Erzeugen der Testumgebung in " << erzeuge[0] << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  Arbeitspool pool(std::max(1u, std::thread::hardware_concurrency()));
+  if (vergleiche) {
+    std::cout << "Groesste Abweichungen von der Referenzimplementierung (Schranken: Laenge " << MAX_ULP_LAENGE << " float-ulp, Winkel "
+      << MAX_WINKELFEHLER << " rad, kr " << MAX_ULP_KRUEMMUNG << " ulp, LS3 " << MAX_ULP_LS3 << " float-ulp, geschrieben "
+      << MAX_ULP_GESCHRIEBEN << " float-ulp, Knick " << MAX_KNICK_GRAD << " Grad)\n";
+    std::ostringstream abweichungen;
+    Vergleich vergleich(abweichungen);
+    VergleicheBeschreibungen(vergleich);
+    std::cout << "Dateibeschreibungen: LS3 " << vergleich.maxUlpLS3 << " float-ulp  "
+      << (vergleich.anzahlFehler() == 0 ? "ok" : std::to_string(vergleich.anzahlFehler()) + " Fehler") << "\n" << abweichungen.str();
+    std::cout << std::setw(10) << "Elemente" << std::setw(8) << "Weichen" << std::setw(11) << "Korrigiert" << std::setw(9) << "Laenge"
+      << std::setw(12) << "Winkel" << std::setw(8) << "kr" << std::setw(8) << "LS3" << std::setw(12) << "Geschrieben" << std::setw(8) << "Knick" << std::setw(8) << "Verkn." << "\n";
+    bool ok = (vergleich.anzahlFehler() == 0);
+    for (size_t anzahlElemente = 1000; anzahlElemente <= maxElemente; anzahlElemente *= 10) {
+      ok = Vergleiche(anzahlElemente, typen, verzeichnis, pool) && ok;
+    }
+    return ok ? 0 : 1;
+  }
+
+  std::cout << "Zeiten in ms (Lesen/El. in ns), beste von " << wiederholungen << " Wiederholungen, " << pool.anzahlThreads() << " Threads\n";
+  std::cout << std::setw(10) << "Elemente" << std::setw(8) << "Weichen" << std::setw(12) << "Einlesen" << std::setw(12) << "FindeWeich."
+    << std::setw(12) << "Geometrie" << std::setw(12) << "Zuordnung" << std::setw(12) << "Korrektur" << std::setw(12) << "Schreiben"
+    << std::setw(10) << "Lesen/El." << "\n";
+  for (size_t anzahlElemente = 1000; anzahlElemente <= maxElemente; anzahlElemente *= 10) {
+    if (!Messe(anzahlElemente, typen, verzeichnis, wiederholungen, pool)) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include "dateiinhalt.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DATEIINHALT_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Dateiinhalt::Dateiinhalt(Dateiinhalt&& other) noexcept {
+  *this = std::move(other);
+}
+
+Dateiinhalt& Dateiinhalt::operator=(Dateiinhalt&& other) noexcept {
+  if (this != &other) {
+    Freigeben();
+    m_puffer = std::move(other.m_puffer);
+    m_daten = other.m_eingeblendet ? other.m_daten : (m_puffer.empty() ? "" : m_puffer.data());
+    m_groesse = other.m_groesse;
+    m_eingeblendet = other.m_eingeblendet;
+    other.m_daten = "";
+    other.m_groesse = 0;
+    other.m_eingeblendet = false;
+  }
+  return *this;
+}
+
+Dateiinhalt::~Dateiinhalt() {
+  Freigeben();
+}
+
+void Dateiinhalt::Freigeben() {
+#ifdef DATEIINHALT_MMAP
+  if (m_eingeblendet) {
+    ::munmap(const_cast<char*>(m_daten), m_groesse);
+  }
+#endif
+  m_puffer.clear();
+  m_daten = "";
+  m_groesse = 0;
+  m_eingeblendet = false;
+}
+
+bool Dateiinhalt::Lies(const std::string& dateiname, bool mmap) {
+  Freigeben();
+
+#ifdef DATEIINHALT_MMAP
+  if (mmap) {
+    const int fd = ::open(dateiname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    const long seitengroesse = ::sysconf(_SC_PAGESIZE);
+    // Der Rest der letzten Seite hinter dem Dateiende ist mit Nullen gefuellt und dient als Nullterminator.
+    // Endet die Datei genau an einer Seitengrenze (oder ist leer), gibt es keinen solchen Rest.
+    if (::fstat(fd, &st) == 0 && st.st_size > 0 && seitengroesse > 0 && (st.st_size % seitengroesse) != 0) {
+      void* adresse = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (adresse != MAP_FAILED) {
+        // Der Parser liest die Datei von vorne nach hinten
+        ::madvise(adresse, st.st_size, MADV_SEQUENTIAL);
+        ::madvise(adresse, st.st_size, MADV_WILLNEED);
+        m_daten = static_cast<const char*>(adresse);
+        m_groesse = st.st_size;
+        m_eingeblendet = true;
+        ::close(fd);
+        return true;
+      }
+    }
+    ::close(fd);
+  }
+#else
+  (void)mmap;
+#endif
+
+  std::ifstream infile(dateiname, std::ios::binary | std::ios::ate);
+  if (!infile) {
+    return false;
+  }
+  const auto groesse = static_cast<size_t>(infile.tellg());
+  infile.seekg(0);
+  m_puffer.resize(groesse + 1);
+  if (!infile.read(m_puffer.data(), groesse)) {
+    m_puffer.clear();
+    return false;
+  }
+  m_puffer[groesse] = '\0';
+  m_daten = m_puffer.data();
+  m_groesse = groesse;
+  return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Inhalt einer Eingabedatei, immer nullterminiert.
+// Wenn moeglich, wird die Datei per mmap in den Speicher eingeblendet, sodass der Inhalt direkt
+// aus dem Page Cache gelesen wird, ohne eine Kopie auf dem Heap anzulegen.
+class Dateiinhalt {
+ public:
+  Dateiinhalt() = default;
+  Dateiinhalt(const Dateiinhalt&) = delete;
+  Dateiinhalt& operator=(const Dateiinhalt&) = delete;
+  Dateiinhalt(Dateiinhalt&& other) noexcept;
+  Dateiinhalt& operator=(Dateiinhalt&& other) noexcept;
+  ~Dateiinhalt();
+
+  // Liest die Datei `dateiname` ein. Bei `mmap == false` oder wenn die Datei nicht eingeblendet werden kann,
+  // wird sie in einen Heap-Puffer gelesen. Gibt false zurueck, wenn die Datei nicht gelesen werden konnte.
+  bool Lies(const std::string& dateiname, bool mmap);
+
+  const char* data() const { return m_daten; }
+  size_t size() const { return m_groesse; }  // ohne Nullterminator
+  bool eingeblendet() const { return m_eingeblendet; }
+
+ private:
+  void Freigeben();
+
+  const char* m_daten = "";
+  size_t m_groesse = 0;
+  bool m_eingeblendet = false;
+  std::vector<char> m_puffer;
+};
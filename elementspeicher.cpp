@@ -0,0 +1,95 @@
+#include "elementspeicher.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Die Elemente sind kleine Allokationen, deren Speicher die glibc nach dem Loeschen im Heap behaelt.
+// Ganze freie Seiten werden hier an das Betriebssystem zurueckgegeben. malloc_trim durchlaeuft den ganzen Heap
+// und lohnt sich erst, wenn viele Elemente geloescht wurden.
+constexpr size_t MIN_ANZAHL_FREIGABE = size_t { 1 } << 16;
+
+void GibSpeicherZurueck() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+}  // namespace
+
+void Elementspeicher::Entnimm(size_t anzahl, std::vector<std::unique_ptr<StrElement>>& ziel) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  anzahl = std::min(anzahl, m_frei.size());
+  std::move(m_frei.end() - anzahl, m_frei.end(), std::back_inserter(ziel));
+  m_frei.resize(m_frei.size() - anzahl);
+}
+
+void Elementspeicher::Zurueckgeben(std::vector<std::unique_ptr<StrElement>>& elemente) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frei.reserve(std::min(m_frei.size() + elemente.size(), m_maxAnzahl));
+    for (auto& element : elemente) {
+      if (m_frei.size() >= m_maxAnzahl) {
+        break;
+      }
+      if (element) {
+        m_frei.push_back(std::move(element));
+      }
+    }
+  }
+  // Ueberzaehlige Elemente ausserhalb des Mutex loeschen
+  const auto anzahlGeloescht = std::count_if(elemente.begin(), elemente.end(), [](const auto& element) { return element != nullptr; });
+  elemente.clear();
+  if (static_cast<size_t>(anzahlGeloescht) >= MIN_ANZAHL_FREIGABE) {
+    GibSpeicherZurueck();
+  }
+}
+
+void Elementspeicher::Leeren() {
+  std::vector<std::unique_ptr<StrElement>> frei;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    frei.swap(m_frei);
+  }
+  frei.clear();
+  GibSpeicherZurueck();
+}
+
+size_t Elementspeicher::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_frei.size();
+}
+
+Elementquelle::~Elementquelle() {
+  if (m_speicher && !m_vorrat.empty()) {
+    m_speicher->Zurueckgeben(m_vorrat);
+  }
+}
+
+std::unique_ptr<StrElement> Elementquelle::Neu() {
+  constexpr size_t blockgroesse = 1024;
+  if (m_vorrat.empty() && m_speicher) {
+    m_speicher->Entnimm(blockgroesse, m_vorrat);
+  }
+  if (m_vorrat.empty()) {
+    return std::make_unique<StrElement>();
+  }
+
+  auto result = std::move(m_vorrat.back());
+  m_vorrat.pop_back();
+  // Zuruecksetzen, aber den Speicher der Nachfolgervektoren behalten
+  auto nachNorm = std::move(result->children_NachNorm);
+  auto nachGegen = std::move(result->children_NachGegen);
+  *result = StrElement();
+  nachNorm.clear();
+  nachGegen.clear();
+  result->children_NachNorm = std::move(nachNorm);
+  result->children_NachGegen = std::move(nachGegen);
+  return result;
+}
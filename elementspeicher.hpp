@@ -0,0 +1,60 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Vorrat an Streckenelementen, die zwischen den Dateien eines Stapellaufs wiederverwendet werden.
+// Die Elemente einer freigegebenen Streckendatei werden nicht geloescht, sondern hier abgelegt und beim
+// Lesen der naechsten Datei zurueckgesetzt wiederverwendet; die Nachfolgervektoren behalten dabei ihren
+// Speicher. Im eingeschwungenen Zustand entfallen so fast alle Allokationen und Freigaben pro Element.
+// Die Elemente muessen einzeln auf dem Heap liegen, weil der Zusi-Parser sie als std::unique_ptr haelt.
+// Es werden hoechstens `maxAnzahl` freie Elemente aufbewahrt, damit eine einzelne grosse Datei nicht
+// fuer den Rest des Stapellaufs ihren ganzen Speicher belegt; ueberzaehlige Elemente werden geloescht
+// und ihr Speicher (mit der glibc) an das Betriebssystem zurueckgegeben.
+// Thread-sicher.
+class Elementspeicher {
+ public:
+  // 2^18 Elemente belegen mit ihren Nachfolgervektoren etwa 65 MB
+  static constexpr size_t STANDARD_MAX_ANZAHL = size_t { 1 } << 18;
+
+  explicit Elementspeicher(size_t maxAnzahl = STANDARD_MAX_ANZAHL) : m_maxAnzahl(maxAnzahl) {}
+
+  // Haengt bis zu `anzahl` Elemente an `ziel` an (ohne sie zurueckzusetzen).
+  void Entnimm(size_t anzahl, std::vector<std::unique_ptr<StrElement>>& ziel);
+
+  // Uebernimmt Elemente aus `elemente` (nullptr werden ignoriert), bis `maxAnzahl` erreicht ist,
+  // loescht den Rest und leert den Vektor.
+  void Zurueckgeben(std::vector<std::unique_ptr<StrElement>>& elemente);
+
+  // Loescht alle freien Elemente und gibt ihren Speicher zurueck, z.B. am Ende des Stapellaufs.
+  void Leeren();
+
+  size_t size() const;
+
+ private:
+  const size_t m_maxAnzahl;
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<StrElement>> m_frei;
+};
+
+// Liefert neue Streckenelemente fuer einen Leser, bevorzugt aus einem Elementspeicher.
+// Entnimmt Elemente blockweise, damit mehrere Leser nur selten gleichzeitig auf den Speicher zugreifen.
+// Nicht verbrauchte Elemente gehen im Destruktor zurueck.
+class Elementquelle {
+ public:
+  explicit Elementquelle(Elementspeicher* speicher) : m_speicher(speicher) {}
+  Elementquelle(const Elementquelle&) = delete;
+  Elementquelle& operator=(const Elementquelle&) = delete;
+  ~Elementquelle();
+
+  // Ein Element im Ausgangszustand, wie von std::make_unique<StrElement>()
+  std::unique_ptr<StrElement> Neu();
+
+ private:
+  Elementspeicher* m_speicher;
+  std::vector<std::unique_ptr<StrElement>> m_vorrat;
+};
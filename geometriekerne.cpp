@@ -0,0 +1,197 @@
+#include "geometriekerne.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define GEOMETRIEKERNE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GEOMETRIEKERNE_SSE2
+#endif
+
+namespace {
+
+// Operationen auf einem Vektor von `breite` doubles. Die Kerne sind einmal als Template geschrieben
+// und werden fuer den jeweiligen Befehlssatz instanziiert.
+#if defined(GEOMETRIEKERNE_AVX2)
+struct Vektor {
+  using V = __m256d;
+  static constexpr size_t breite = 4;
+  static constexpr const char* name = "AVX2";
+
+  static V Laden(const double* p) { return _mm256_loadu_pd(p); }
+  static void Speichern(double* p, V a) { _mm256_storeu_pd(p, a); }
+  static V Wert(double a) { return _mm256_set1_pd(a); }
+  static V Add(V a, V b) { return _mm256_add_pd(a, b); }
+  static V Sub(V a, V b) { return _mm256_sub_pd(a, b); }
+  static V Mul(V a, V b) { return _mm256_mul_pd(a, b); }
+  static V Div(V a, V b) { return _mm256_div_pd(a, b); }
+  static V MulAdd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }  // a * b + c
+  static V Sqrt(V a) { return _mm256_sqrt_pd(a); }
+  static V Min(V a, V b) { return _mm256_min_pd(a, b); }
+  static V Max(V a, V b) { return _mm256_max_pd(a, b); }
+  static V Abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+  static V Vorzeichen(V a) { return _mm256_and_pd(_mm256_set1_pd(-0.0), a); }
+  static V Oder(V a, V b) { return _mm256_or_pd(a, b); }
+  static V Kleiner(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static V Waehle(V maske, V wennJa, V wennNein) { return _mm256_blendv_pd(wennNein, wennJa, maske); }
+};
+#elif defined(GEOMETRIEKERNE_SSE2)
+struct Vektor {
+  using V = __m128d;
+  static constexpr size_t breite = 2;
+  static constexpr const char* name = "SSE2";
+
+  static V Laden(const double* p) { return _mm_loadu_pd(p); }
+  static void Speichern(double* p, V a) { _mm_storeu_pd(p, a); }
+  static V Wert(double a) { return _mm_set1_pd(a); }
+  static V Add(V a, V b) { return _mm_add_pd(a, b); }
+  static V Sub(V a, V b) { return _mm_sub_pd(a, b); }
+  static V Mul(V a, V b) { return _mm_mul_pd(a, b); }
+  static V Div(V a, V b) { return _mm_div_pd(a, b); }
+  static V MulAdd(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+  static V Sqrt(V a) { return _mm_sqrt_pd(a); }
+  static V Min(V a, V b) { return _mm_min_pd(a, b); }
+  static V Max(V a, V b) { return _mm_max_pd(a, b); }
+  static V Abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+  static V Vorzeichen(V a) { return _mm_and_pd(_mm_set1_pd(-0.0), a); }
+  static V Oder(V a, V b) { return _mm_or_pd(a, b); }
+  static V Kleiner(V a, V b) { return _mm_cmplt_pd(a, b); }
+  static V Waehle(V maske, V wennJa, V wennNein) { return _mm_or_pd(_mm_and_pd(maske, wennJa), _mm_andnot_pd(maske, wennNein)); }
+};
+#else
+struct Vektor {
+  using V = double;
+  static constexpr size_t breite = 1;
+  static constexpr const char* name = "skalar";
+
+  static V Laden(const double* p) { return *p; }
+  static void Speichern(double* p, V a) { *p = a; }
+  static V Wert(double a) { return a; }
+  static V Add(V a, V b) { return a + b; }
+  static V Sub(V a, V b) { return a - b; }
+  static V Mul(V a, V b) { return a * b; }
+  static V Div(V a, V b) { return a / b; }
+  static V MulAdd(V a, V b, V c) { return a * b + c; }
+  static V Sqrt(V a) { return std::sqrt(a); }
+  static V Min(V a, V b) { return a < b ? a : b; }
+  static V Max(V a, V b) { return a > b ? a : b; }
+  static V Abs(V a) { return std::abs(a); }
+  static V Vorzeichen(V a) { return std::signbit(a) ? -0.0 : 0.0; }
+  static V Oder(V a, V b) { return std::signbit(b) ? -a : a; }  // nur zum Setzen des Vorzeichenbits verwendet
+  static V Kleiner(V a, V b) { return a < b ? 1.0 : 0.0; }
+  static V Waehle(V maske, V wennJa, V wennNein) { return maske != 0.0 ? wennJa : wennNein; }
+};
+#endif
+
+using V = Vektor::V;
+
+// atan(t) fuer |t| <= tan(π/8) als t + t^3 * P(t^2), Tschebyschow-Approximation vom Grad 10 in t^2
+// (Fehler < 6e-17 in double).
+V AtanKern(V t) {
+  const V z = Vektor::Mul(t, t);
+  V p = Vektor::Wert(2.11362001797983264319e-02);
+  p = Vektor::MulAdd(p, z, Vektor::Wert(-4.34811354837353890740e-02));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(5.68836845993835432239e-02));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(-6.64023730809807856518e-02));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(7.68995387126955120852e-02));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(-9.09077310311926651263e-02));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(1.11111061819408844955e-01));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(-1.42857141810267359908e-01));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(1.99999999988560190494e-01));
+  p = Vektor::MulAdd(p, z, Vektor::Wert(-3.33333333333284452250e-01));
+  return Vektor::MulAdd(Vektor::Mul(t, z), p, t);
+}
+
+// atan2(y, x). Reduktion auf den ersten Oktanten, dort fuer Quotienten ueber tan(π/8)
+// ueber atan(q) = π/4 + atan((q - 1) / (q + 1)), mit nur einer Division.
+V Atan2(V y, V x) {
+  const V ax = Vektor::Abs(x);
+  const V ay = Vektor::Abs(y);
+  const V klein = Vektor::Min(ax, ay);
+  const V gross = Vektor::Max(ax, ay);
+
+  const V zweiterTeil = Vektor::Kleiner(Vektor::Mul(Vektor::Wert(0.41421356237309504880), gross), klein);
+  const V zaehler = Vektor::Waehle(zweiterTeil, Vektor::Sub(klein, gross), klein);
+  const V nenner = Vektor::Max(Vektor::Waehle(zweiterTeil, Vektor::Add(klein, gross), gross), Vektor::Wert(DBL_MIN));
+  V result = AtanKern(Vektor::Div(zaehler, nenner));
+  result = Vektor::Waehle(zweiterTeil, Vektor::Add(result, Vektor::Wert(M_PI_4)), result);
+
+  result = Vektor::Waehle(Vektor::Kleiner(ax, ay), Vektor::Sub(Vektor::Wert(M_PI_2), result), result);
+  result = Vektor::Waehle(Vektor::Kleiner(x, Vektor::Wert(0.0)), Vektor::Sub(Vektor::Wert(M_PI), result), result);
+  return Vektor::Oder(result, Vektor::Vorzeichen(y));
+}
+
+// Wendet `f` auf alle Bloecke von `Vektor::breite` Werten an. Der Rest am Ende wird ueber einen
+// aufgefuellten Puffer ebenfalls vektoriell berechnet, damit alle Werte dieselben Rundungsfehler haben.
+template<size_t AnzahlEingaben, size_t AnzahlAusgaben, typename F>
+void FuerAlleBloecke(size_t n, const double* const (&eingaben)[AnzahlEingaben], double* const (&ausgaben)[AnzahlAusgaben], F&& f) {
+  size_t i = 0;
+  for (; i + Vektor::breite <= n; i += Vektor::breite) {
+    V ein[AnzahlEingaben];
+    V aus[AnzahlAusgaben];
+    for (size_t k = 0; k < AnzahlEingaben; ++k) {
+      ein[k] = Vektor::Laden(eingaben[k] + i);
+    }
+    f(ein, aus);
+    for (size_t k = 0; k < AnzahlAusgaben; ++k) {
+      Vektor::Speichern(ausgaben[k] + i, aus[k]);
+    }
+  }
+  if (i < n) {
+    double puffer[AnzahlEingaben + AnzahlAusgaben][Vektor::breite] = {};
+    V ein[AnzahlEingaben];
+    V aus[AnzahlAusgaben];
+    for (size_t k = 0; k < AnzahlEingaben; ++k) {
+      std::copy(eingaben[k] + i, eingaben[k] + n, puffer[k]);
+      ein[k] = Vektor::Laden(puffer[k]);
+    }
+    f(ein, aus);
+    for (size_t k = 0; k < AnzahlAusgaben; ++k) {
+      Vektor::Speichern(puffer[AnzahlEingaben + k], aus[k]);
+      std::copy(puffer[AnzahlEingaben + k], puffer[AnzahlEingaben + k] + (n - i), ausgaben[k] + i);
+    }
+  }
+}
+
+}  // namespace
+
+const char* GeometriekerneBefehlssatz() {
+  return Vektor::name;
+}
+
+void BerechneLaengen(size_t n, const double* dx, const double* dy, const double* dz, double* laenge) {
+  FuerAlleBloecke(n, { dx, dy, dz }, { laenge }, [](const V* ein, V* aus) {
+    aus[0] = Vektor::Sqrt(Vektor::MulAdd(ein[0], ein[0], Vektor::MulAdd(ein[1], ein[1], Vektor::Mul(ein[2], ein[2]))));
+  });
+}
+
+void BerechneSehnenwinkel(size_t n, const double* dx, const double* dy, double* norm, double* gegen) {
+  FuerAlleBloecke(n, { dx, dy }, { norm, gegen }, [](const V* ein, V* aus) {
+    aus[0] = Atan2(ein[1], ein[0]);
+    const V minusNull = Vektor::Wert(-0.0);
+    aus[1] = Atan2(Vektor::Sub(minusNull, ein[1]), Vektor::Sub(minusNull, ein[0]));
+  });
+}
+
+void BerechneTangentenwinkel(size_t n, const double* laenge, const double* kr, double* tangentenwinkel) {
+  FuerAlleBloecke(n, { laenge, kr }, { tangentenwinkel }, [](const V* ein, V* aus) {
+    // Wie Tangentenwinkel: asin(l / (2 * |r|)), mit asin(s) = atan2(s, sqrt((1 - s) * (1 + s)))
+    const V einsDurchKr = Vektor::Div(Vektor::Wert(1.0), ein[1]);
+    const V s = Vektor::Div(ein[0], Vektor::Mul(Vektor::Wert(2.0), Vektor::Abs(einsDurchKr)));
+    const V eins = Vektor::Wert(1.0);
+    const V winkel = Atan2(s, Vektor::Sqrt(Vektor::Mul(Vektor::Sub(eins, s), Vektor::Add(eins, s))));
+    const V gerade = Vektor::Kleiner(Vektor::Abs(ein[1]), Vektor::Wert(1/100000.0));
+    aus[0] = Vektor::Waehle(gerade, Vektor::Wert(0.0), winkel);
+  });
+}
+
+void BerechneWinkelDiff(size_t n, const double* phi1, const double* phi2, double* diff) {
+  FuerAlleBloecke(n, { phi1, phi2 }, { diff }, [](const V* ein, V* aus) {
+    const V diff = Vektor::Abs(Vektor::Sub(ein[0], ein[1]));
+    aus[0] = Vektor::Min(diff, Vektor::Abs(Vektor::Sub(diff, Vektor::Wert(2 * M_PI))));
+  });
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// Vektorisierte Varianten von ElementLaenge, Tangentenwinkel, des Sehnenwinkels aus GetWinkel
+// und von WinkelDiff fuer zusammenhaengende Arrays von `n` Werten.
+//
+// Je nach Uebersetzung werden AVX2/FMA- (4 Werte pro Befehl, CMake-Option RADIUS_BOGENWEICHEN_AVX2; das ganze
+// Programm laeuft dann nur auf CPUs mit AVX2), SSE2- (2 Werte) oder skalare Befehle verwendet. Alle Befehlssaetze rechnen mit denselben Formeln,
+// ein Ergebnis haengt nicht von seiner Position im Array ab. Atan2 und asin werden durch ein Polynom
+// angenaehert. Maximaler Fehler gegenueber der skalaren Berechnung mit std::hypot, atan2 und asin
+// (gemessen ueber 10^7 zufaellige Elemente mit Laengen bis 100 m und Radien ab 1 m):
+//  - Laenge:           1 ulp der exakten Laenge (ElementLaenge rechnet nur mit float-Genauigkeit)
+//  - Sehnenwinkel:     4.5e-16 rad
+//  - Tangentenwinkel:  2.3e-16 rad
+//  - Winkeldifferenz:  exakt
+// Die Eingaben muessen endlich sein. Fuer dx = dy = 0 ist der Sehnenwinkel 0.
+
+// Befehlssatz, mit dem die Kerne uebersetzt wurden ("AVX2", "SSE2" oder "skalar")
+const char* GeometriekerneBefehlssatz();
+
+// laenge[i] = |(dx[i], dy[i], dz[i])|
+void BerechneLaengen(size_t n, const double* dx, const double* dy, const double* dz, double* laenge);
+
+// norm[i] = atan2(dy[i], dx[i]), gegen[i] = atan2(-dy[i], -dx[i])
+void BerechneSehnenwinkel(size_t n, const double* dx, const double* dy, double* norm, double* gegen);
+
+// tangentenwinkel[i] = Tangentenwinkel(laenge[i], kr[i])
+void BerechneTangentenwinkel(size_t n, const double* laenge, const double* kr, double* tangentenwinkel);
+
+// diff[i] = WinkelDiff(phi1[i], phi2[i])
+void BerechneWinkelDiff(size_t n, const double* phi1, const double* phi2, double* diff);
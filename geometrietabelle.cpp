@@ -0,0 +1,65 @@
+#include "geometrietabelle.hpp"
+
+#include "geometriekerne.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+double ElementLaenge(const StrElement& el) {
+  return std::hypot(el.b.X - el.g.X, el.b.Y - el.g.Y, el.b.Z - el.g.Z);
+}
+
+double Tangentenwinkel(double laenge, double kr) {
+  if (std::abs(kr) < 1/100000.0) {
+    return 0;
+  }
+  // Element repraesentiert eine Kreissehne im Kreis mit Radius `radius`
+  // Berechne Sehnenwinkel alpha und daraus Winkel der Kreistangente
+  //  alpha = 2 * asin(l / 2 * radius)
+  //  tangentenwinkel = alpha / 2
+  const double radius = 1.0/kr;
+  return asin(laenge / (2.0 * std::abs(radius)));
+}
+
+Geometrietabelle::Geometrietabelle(const Strecke& strecke) {
+  Reservieren(strecke.children_StrElement.size());
+  Berechne(strecke, 0, size());
+}
+
+Geometrietabelle::Geometrietabelle(const Strecke& strecke, Arbeitspool& pool) {
+  Reservieren(strecke.children_StrElement.size());
+  constexpr size_t blockgroesse = 4096;
+  pool.ParallelFuer((size() + blockgroesse - 1) / blockgroesse, [this, &strecke](size_t block) {
+    Berechne(strecke, block * blockgroesse, std::min(size(), (block + 1) * blockgroesse));
+  });
+}
+
+void Geometrietabelle::Reservieren(size_t anzahlElemente) {
+  m_laenge.resize(anzahlElemente);
+  m_sehnenwinkelNorm.resize(anzahlElemente);
+  m_sehnenwinkelGegen.resize(anzahlElemente);
+  m_kruemmung.resize(anzahlElemente);
+  m_tangentenwinkel.resize(anzahlElemente);
+}
+
+void Geometrietabelle::Berechne(const Strecke& strecke, size_t von, size_t bis) {
+  // Endpunktdifferenzen und Kruemmungen spaltenweise sammeln, dann mit den Vektorkernen auswerten.
+  // Fehlende Elemente ergeben Laenge 0 und Winkel 0.
+  const size_t n = bis - von;
+  std::vector<double> dx(n), dy(n), dz(n);
+  double* kr = m_kruemmung.data() + von;
+  for (size_t i = 0; i < n; ++i) {
+    const auto& el = strecke.children_StrElement[von + i];
+    if (!el) {
+      continue;
+    }
+    dx[i] = el->b.X - el->g.X;
+    dy[i] = el->b.Y - el->g.Y;
+    dz[i] = el->b.Z - el->g.Z;
+    kr[i] = el->kr;
+  }
+
+  BerechneLaengen(n, dx.data(), dy.data(), dz.data(), m_laenge.data() + von);
+  BerechneSehnenwinkel(n, dx.data(), dy.data(), m_sehnenwinkelNorm.data() + von, m_sehnenwinkelGegen.data() + von);
+  BerechneTangentenwinkel(n, m_laenge.data() + von, kr, m_tangentenwinkel.data() + von);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include "arbeitspool.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Abstand der beiden Endpunkte eines Streckenelements.
+double ElementLaenge(const StrElement& el);
+
+// Winkel zwischen Sehne und Kreistangente an den Enden eines Elements der Laenge `laenge`
+// mit Kruemmung `kr`. Bei (nahezu) geraden Elementen 0.
+double Tangentenwinkel(double laenge, double kr);
+
+// Einmal pro Strecke berechnete Geometrie der Streckenelemente, indiziert ueber die Elementnummer
+// und spaltenweise abgelegt (Laenge, Sehnenwinkel je Richtung, Kruemmung, Tangentenwinkel fuer die eigene Kruemmung).
+// Nicht vorhandene Elemente haben ueberall den Wert 0.
+class Geometrietabelle {
+ public:
+  Geometrietabelle() = default;
+  explicit Geometrietabelle(const Strecke& strecke);
+  Geometrietabelle(const Strecke& strecke, Arbeitspool& pool);  // Berechnung verteilt auf die Threads des Pools
+
+  size_t size() const { return m_laenge.size(); }
+
+  double laenge(size_t nr) const { return m_laenge[nr]; }
+
+  // Richtung der Sehne vom Anfang zum Ende des Elements in Norm- bzw. Gegenrichtung, im Intervall [-π, π]
+  double sehnenwinkel(size_t nr, bool normrichtung) const {
+    return normrichtung ? m_sehnenwinkelNorm[nr] : m_sehnenwinkelGegen[nr];
+  }
+
+  // im Element gespeicherte Kruemmung in Normrichtung
+  double kruemmung(size_t nr) const { return m_kruemmung[nr]; }
+
+  // Tangentenwinkel(laenge(nr), kruemmung(nr))
+  double tangentenwinkel(size_t nr) const { return m_tangentenwinkel[nr]; }
+
+ private:
+  void Reservieren(size_t anzahlElemente);
+  void Berechne(const Strecke& strecke, size_t von, size_t bis);
+
+  std::vector<double> m_laenge;
+  std::vector<double> m_sehnenwinkelNorm;
+  std::vector<double> m_sehnenwinkelGegen;
+  std::vector<double> m_kruemmung;
+  std::vector<double> m_tangentenwinkel;
+};
@@ -0,0 +1,79 @@
+#include "knickpruefung.hpp"
+
+#include "bogenweichen.hpp"
+#include "geometriekerne.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Gibt true zurueck, wenn `nachfolger` in Gegenrichtung wieder auf `element` verweist.
+bool HatRueckverweis(const Streckengraph& graph, ElementRichtung element, ElementRichtung nachfolger) {
+  const ElementRichtung rueckwaerts = nachfolger ^ 1;
+  for (auto it = graph.nachfolgerAnfang(rueckwaerts), ende = graph.nachfolgerEnde(rueckwaerts); it != ende; ++it) {
+    if (*it != KEIN_ELEMENT && Nummer(*it) == Nummer(element)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::vector<Stoss> FindeKnicke(const Streckengraph& graph, const Geometrietabelle& geometrie, double schwelle,
+    Arbeitspool& pool, size_t& anzahlStoesse) {
+  constexpr size_t blockgroesse = 4096;
+  const size_t anzahlElemente = graph.anzahlElemente();
+  struct Blockergebnis {
+    std::vector<Stoss> knicke;
+    size_t anzahlStoesse = 0;
+  };
+  std::vector<Blockergebnis> ergebnisse((anzahlElemente + blockgroesse - 1) / blockgroesse);
+
+  pool.ParallelFuer(ergebnisse.size(), [&](size_t block) {
+    std::vector<Stoss> stoesse;
+    std::vector<double> winkelEnde;
+    std::vector<double> winkelAnfang;
+    for (size_t nr = block * blockgroesse, ende = std::min(anzahlElemente, nr + blockgroesse); nr < ende; ++nr) {
+      for (const bool norm : { true, false }) {
+        const ElementRichtung el = MitRichtung(nr, norm);
+        for (auto it = graph.nachfolgerAnfang(el), itEnde = graph.nachfolgerEnde(el); it != itEnde; ++it) {
+          const ElementRichtung nachfolger = *it;
+          if (nachfolger == KEIN_ELEMENT) {
+            continue;
+          }
+          if (Nummer(nachfolger) < nr || (Nummer(nachfolger) == nr && !norm)) {
+            if (HatRueckverweis(graph, el, nachfolger)) {
+              continue;
+            }
+          }
+          stoesse.push_back(Stoss { el, nachfolger, 0 });
+          winkelEnde.push_back(GetWinkel(geometrie, el, ElementEnde::Ende));
+          winkelAnfang.push_back(GetWinkel(geometrie, nachfolger, ElementEnde::Anfang));
+        }
+      }
+    }
+
+    std::vector<double> knicke(stoesse.size());
+    BerechneWinkelDiff(stoesse.size(), winkelEnde.data(), winkelAnfang.data(), knicke.data());
+
+    auto& ergebnis = ergebnisse[block];
+    ergebnis.anzahlStoesse = stoesse.size();
+    for (size_t i = 0; i < stoesse.size(); ++i) {
+      if (knicke[i] > schwelle) {
+        stoesse[i].knick = knicke[i];
+        ergebnis.knicke.push_back(stoesse[i]);
+      }
+    }
+  });
+
+  std::vector<Stoss> result;
+  anzahlStoesse = 0;
+  for (auto& ergebnis : ergebnisse) {
+    anzahlStoesse += ergebnis.anzahlStoesse;
+    result.insert(result.end(), ergebnis.knicke.begin(), ergebnis.knicke.end());
+  }
+  // stabil, damit gleich grosse Knicke nach Elementnummer sortiert bleiben
+  std::stable_sort(result.begin(), result.end(), [](const Stoss& a, const Stoss& b) { return a.knick > b.knick; });
+  return result;
+}
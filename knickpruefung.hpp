@@ -0,0 +1,22 @@
+#pragma once
+
+#include "arbeitspool.hpp"
+#include "geometrietabelle.hpp"
+#include "streckengraph.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Stoss zwischen dem Ende eines Elements und dem Anfang eines seiner Nachfolger.
+struct Stoss {
+  ElementRichtung element;
+  ElementRichtung nachfolger;
+  double knick;  // rad
+};
+
+// Bestimmt den Knick an allen Stoessen der Strecke und gibt die Stoesse mit einem Knick ueber `schwelle`
+// absteigend nach Knick sortiert zurueck. Ein beidseitig verknuepfter Stoss wird nur einmal gezaehlt,
+// und zwar vom Element mit der kleineren Nummer aus. `anzahlStoesse` enthaelt danach die Anzahl aller Stoesse.
+// Liest nur Nachfolgergraph und Geometrietabelle, nicht die Streckenelemente selbst.
+std::vector<Stoss> FindeKnicke(const Streckengraph& graph, const Geometrietabelle& geometrie, double schwelle,
+    Arbeitspool& pool, size_t& anzahlStoesse);
@@ -0,0 +1,121 @@
+// Prueft FindeKnicke (Knickpruefung -k) auf einer erzeugten Strecke (siehe streckengenerator.hpp): Die unveraenderte
+// Strecke hat keine Knicke, ein eingebauter Knick wird mit Element, Richtung und Winkel gemeldet, auch wenn der Stoss
+// nur in Gegenrichtung verknuepft ist. Die Testdatei wird im aktuellen Verzeichnis angelegt.
+
+#include "arbeitspool.hpp"
+#include "geometrietabelle.hpp"
+#include "knickpruefung.hpp"
+#include "protokoll.hpp"
+#include "streckendatei.hpp"
+#include "streckengenerator.hpp"
+#include "streckengraph.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int anzahlFehler = 0;
+
+void Pruefe(bool bedingung, const std::string& beschreibung) {
+  if (!bedingung) {
+    std::cout << "FEHLER: " << beschreibung << "\n";
+    ++anzahlFehler;
+  }
+}
+
+const std::string DATEINAME = "knickpruefung_test.st3";
+constexpr double GRAD = M_PI / 180.0;
+constexpr double SCHWELLE = 0.1 * GRAD;
+constexpr double MAX_WINKELFEHLER = 0.001 * GRAD;  // Koordinaten sind float, im Abstand einiger km vom Ursprung
+
+// Dreht `p` in der XY-Ebene um `winkel` um `mitte`.
+void Drehe(Vec3& p, const Vec3& mitte, double winkel) {
+  const double dx = p.X - mitte.X;
+  const double dy = p.Y - mitte.Y;
+  p.X = static_cast<float>(mitte.X + dx * std::cos(winkel) - dy * std::sin(winkel));
+  p.Y = static_cast<float>(mitte.Y + dx * std::sin(winkel) + dy * std::cos(winkel));
+}
+
+std::vector<Stoss> Knicke(const Strecke& strecke, Arbeitspool& pool, size_t& anzahlStoesse) {
+  return FindeKnicke(Streckengraph(strecke), Geometrietabelle(strecke), SCHWELLE, pool, anzahlStoesse);
+}
+
+// Prueft, dass genau ein Knick von `element` nach `nachfolger` mit `winkel` gemeldet wird.
+void PruefeEinenKnick(const std::vector<Stoss>& knicke, ElementRichtung element, ElementRichtung nachfolger, double winkel,
+    const std::string& variante) {
+  Pruefe(knicke.size() == 1, variante + ": genau ein Knick gemeldet (" + std::to_string(knicke.size()) + ")");
+  if (knicke.empty()) {
+    return;
+  }
+  const auto& stoss = knicke.front();
+  Pruefe(stoss.element == element && stoss.nachfolger == nachfolger, variante + ": Element und Richtung, gemeldet "
+      + std::to_string(Nummer(stoss.element)) + (Normrichtung(stoss.element) ? " (Norm)" : " (Gegen)") + " -> "
+      + std::to_string(Nummer(stoss.nachfolger)) + (Normrichtung(stoss.nachfolger) ? " (Norm)" : " (Gegen)"));
+  Pruefe(std::abs(stoss.knick - winkel) <= MAX_WINKELFEHLER,
+      variante + ": Knickwinkel " + std::to_string(stoss.knick / GRAD) + " Grad statt " + std::to_string(winkel / GRAD));
+}
+
+}  // namespace
+
+int main() {
+  std::vector<Weichentyp> typen(2);
+  typen[0].muster = "54 300 1-9 Links";
+  typen[0].originalPfad = "Weichen\\54_300_1-9_Links.st3";
+  typen[0].radius = 300;
+  typen[0].links = true;
+  typen[1].muster = "54 1200 1-18_5 Rechts";
+  typen[1].originalPfad = "Weichen\\54_1200_1-18_5_Rechts.st3";
+  typen[1].radius = 1200;
+
+  Generatorparameter parameter;
+  parameter.anzahlElemente = 5000;
+  parameter.anzahlBogenweichen = 100;
+  {
+    std::ofstream datei(DATEINAME, std::ios::binary | std::ios::trunc);
+    ErzeugeStreckendatei(datei, parameter, typen);
+  }
+
+  Arbeitspool pool(4);
+  std::ostringstream meldungen;
+  Protokoll log(meldungen, Ausgabestufe::Fehler);
+  const auto datei = LiesStreckendatei(DATEINAME, Leseoptionen {}, log);
+  std::remove(DATEINAME.c_str());
+  if (!datei || !datei->zusi->Strecke) {
+    std::cout << "FEHLER: Erzeugte Strecke nicht lesbar\n" << meldungen.str();
+    return 1;
+  }
+  auto& strecke = *datei->zusi->Strecke;
+  const size_t letztes = parameter.anzahlElemente;
+
+  // Jeder Stoss ist in beiden Richtungen verknuepft und wird einmal gezaehlt, keiner hat einen Knick
+  size_t anzahlStoesse = 0;
+  auto knicke = Knicke(strecke, pool, anzahlStoesse);
+  Pruefe(anzahlStoesse == parameter.anzahlElemente - 1, "Erzeugte Strecke: Anzahl Stoesse " + std::to_string(anzahlStoesse));
+  Pruefe(knicke.empty(), "Erzeugte Strecke: keine Knicke, gemeldet " + std::to_string(knicke.size()));
+
+  // Letztes Element um seinen Anfang gedreht: Knick am Stoss davor, vom Element mit der kleineren Nummer aus gemeldet
+  auto& ende = *strecke.children_StrElement[letztes];
+  Drehe(ende.b, ende.g, 5 * GRAD);
+  knicke = Knicke(strecke, pool, anzahlStoesse);
+  PruefeEinenKnick(knicke, MitRichtung(letztes - 1, true), MitRichtung(letztes, true), 5 * GRAD, "Knick am Ende");
+  Drehe(ende.b, ende.g, -5 * GRAD);
+
+  // Erstes Element um sein Ende gedreht und nur noch vom zweiten aus (in Gegenrichtung) verknuepft
+  auto& anfang = *strecke.children_StrElement[1];
+  Drehe(anfang.g, anfang.b, -3 * GRAD);
+  anfang.children_NachNorm.clear();
+  knicke = Knicke(strecke, pool, anzahlStoesse);
+  Pruefe(anzahlStoesse == parameter.anzahlElemente - 1, "Knick am Anfang: Anzahl Stoesse " + std::to_string(anzahlStoesse));
+  PruefeEinenKnick(knicke, MitRichtung(2, false), MitRichtung(1, false), 3 * GRAD, "Knick am Anfang, nur Gegenrichtung");
+
+  if (anzahlFehler == 0) {
+    std::cout << "knickpruefung_test: ok\n";
+  }
+  return anzahlFehler == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Neue Kruemmungen von Streckenelementen, indiziert ueber die Elementnummer.
+// Ein Bitset merkt sich, fuer welche Elemente ein Wert gesetzt ist.
+class Kruemmungstabelle {
+ public:
+  explicit Kruemmungstabelle(size_t anzahlElemente = 0)
+    : m_gesetzt((anzahlElemente + 63) / 64), m_werte(anzahlElemente) {}
+
+  size_t size() const { return m_werte.size(); }
+  size_t anzahlGesetzt() const { return m_anzahlGesetzt; }
+
+  bool gesetzt(size_t nr) const {
+    return nr < m_werte.size() && ((m_gesetzt[nr >> 6] >> (nr & 63)) & 1);
+  }
+
+  double wert(size_t nr) const { return m_werte[nr]; }
+
+  // Setzt die Kruemmung von Element `nr`. Ist fuer das Element bereits eine andere Kruemmung gesetzt,
+  // bleibt diese erhalten und es wird false zurueckgegeben.
+  bool Setze(size_t nr, double kr) {
+    if (nr >= m_werte.size()) {
+      m_werte.resize(nr + 1);
+      m_gesetzt.resize((nr + 64) / 64);
+    }
+    auto& wort = m_gesetzt[nr >> 6];
+    const uint64_t bit = uint64_t { 1 } << (nr & 63);
+    if (wort & bit) {
+      return m_werte[nr] == kr;
+    }
+    wort |= bit;
+    m_werte[nr] = kr;
+    ++m_anzahlGesetzt;
+    return true;
+  }
+
+  // Ruft `f(nr, kr)` fuer alle gesetzten Elemente in aufsteigender Reihenfolge auf.
+  template<typename F>
+  void FuerAlleGesetzten(F&& f) const {
+    for (size_t i = 0, len = m_gesetzt.size(); i < len; ++i) {
+      for (uint64_t wort = m_gesetzt[i]; wort != 0; wort &= wort - 1) {
+        const size_t nr = i * 64 + NiedrigstesBit(wort);
+        f(nr, m_werte[nr]);
+      }
+    }
+  }
+
+ private:
+  static unsigned NiedrigstesBit(uint64_t wort) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, wort);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(wort));
+#endif
+  }
+
+  std::vector<uint64_t> m_gesetzt;
+  std::vector<double> m_werte;
+  size_t m_anzahlGesetzt = 0;
+};
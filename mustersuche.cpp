@@ -0,0 +1,75 @@
+#include "mustersuche.hpp"
+
+#include <algorithm>
+#include <queue>
+
+Mustersuche::Mustersuche(const std::vector<std::string_view>& muster) {
+  // Trie aufbauen
+  for (size_t idx = 0; idx < muster.size(); ++idx) {
+    uint32_t zustand = 0;
+    for (const char c : muster[idx]) {
+      const auto zeichen = static_cast<unsigned char>(c);
+      auto& kanten = m_zustaende[zustand].kanten;
+      const auto it = std::lower_bound(kanten.begin(), kanten.end(), zeichen,
+          [](const auto& kante, unsigned char z) { return kante.first < z; });
+      if (it != kanten.end() && it->first == zeichen) {
+        zustand = it->second;
+      } else {
+        const auto neu = static_cast<uint32_t>(m_zustaende.size());
+        kanten.insert(it, { zeichen, neu });
+        m_zustaende.emplace_back();  // invalidiert `kanten`
+        zustand = neu;
+      }
+    }
+    m_zustaende[zustand].muster.push_back(static_cast<uint32_t>(idx));
+  }
+
+  // Fehler- und Ausgabelinks in Breitensuche berechnen
+  std::queue<uint32_t> warteschlange;
+  for (const auto& [zeichen, kind] : m_zustaende[0].kanten) {
+    warteschlange.push(kind);
+  }
+  while (!warteschlange.empty()) {
+    const uint32_t zustand = warteschlange.front();
+    warteschlange.pop();
+    for (const auto& [zeichen, kind] : m_zustaende[zustand].kanten) {
+      uint32_t f = m_zustaende[zustand].fehlerLink;
+      while (f != 0 && Kante(f, zeichen) == 0) {
+        f = m_zustaende[f].fehlerLink;
+      }
+      const uint32_t fehlerLink = Kante(f, zeichen);
+      m_zustaende[kind].fehlerLink = fehlerLink;
+      m_zustaende[kind].ausgabeLink = m_zustaende[fehlerLink].muster.empty() ? m_zustaende[fehlerLink].ausgabeLink : fehlerLink;
+      warteschlange.push(kind);
+    }
+  }
+}
+
+uint32_t Mustersuche::Kante(uint32_t zustand, unsigned char zeichen) const {
+  const auto& kanten = m_zustaende[zustand].kanten;
+  const auto it = std::lower_bound(kanten.begin(), kanten.end(), zeichen,
+      [](const auto& kante, unsigned char z) { return kante.first < z; });
+  return (it != kanten.end() && it->first == zeichen) ? it->second : 0;
+}
+
+std::vector<size_t> Mustersuche::Finde(std::string_view text) const {
+  // Leere Muster kommen in jedem Text vor
+  std::vector<size_t> result(m_zustaende[0].muster.begin(), m_zustaende[0].muster.end());
+
+  uint32_t zustand = 0;
+  for (const char c : text) {
+    const auto zeichen = static_cast<unsigned char>(c);
+    uint32_t naechster;
+    while ((naechster = Kante(zustand, zeichen)) == 0 && zustand != 0) {
+      zustand = m_zustaende[zustand].fehlerLink;
+    }
+    zustand = naechster;
+    for (uint32_t ausgabe = zustand; ausgabe != 0; ausgabe = m_zustaende[ausgabe].ausgabeLink) {
+      result.insert(result.end(), m_zustaende[ausgabe].muster.begin(), m_zustaende[ausgabe].muster.end());
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
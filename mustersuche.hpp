@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Sucht in einem einzigen Durchlauf ueber einen Text nach beliebig vielen Mustern gleichzeitig
+// (Aho-Corasick-Automat). Die Laufzeit einer Suche haengt nur von der Laenge des Textes
+// und der Anzahl der Treffer ab, nicht von der Anzahl der Muster.
+class Mustersuche {
+ public:
+  Mustersuche() = default;
+  explicit Mustersuche(const std::vector<std::string_view>& muster);
+
+  // Gibt die Indizes aller Muster zurueck, die in `text` vorkommen, in aufsteigender Reihenfolge.
+  std::vector<size_t> Finde(std::string_view text) const;
+
+ private:
+  struct Zustand {
+    std::vector<std::pair<unsigned char, uint32_t>> kanten;  // nach Zeichen sortiert
+    uint32_t fehlerLink = 0;   // Zustand fuer das laengste echte Suffix, das Praefix eines Musters ist
+    uint32_t ausgabeLink = 0;  // naechster Zustand auf der Fehlerkette, an dem ein Muster endet (0: keiner)
+    std::vector<uint32_t> muster;  // Muster, die in diesem Zustand enden
+  };
+
+  uint32_t Kante(uint32_t zustand, unsigned char zeichen) const;  // 0, falls nicht vorhanden
+
+  std::vector<Zustand> m_zustaende { Zustand() };  // Zustand 0 ist die Wurzel
+};
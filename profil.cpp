@@ -0,0 +1,306 @@
+#include "profil.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <time.h>
+#define PROFIL_POSIX
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#define PROFIL_WINDOWS
+#endif
+
+namespace {
+
+const char* const phasennamen[] = {
+  "Weichenzuordnung",
+  "Streckendatei einlesen",
+  "Verknuepfen",
+  "FindeWeichen",
+  "Geometrietabelle",
+  "Unverbogene Weiche suchen",
+  "Unverbogene Weiche laden",
+  "LS3 suchen",
+  "LS3 einlesen",
+  "Biegeparameter",
+  "Kruemmung korrigieren",
+  "Knickpruefung",
+  "Schreiben",
+};
+static_assert(sizeof(phasennamen) / sizeof(phasennamen[0]) == static_cast<size_t>(Phase::ANZAHL));
+
+const char* const zaehlernamen[] = {
+  "Streckendateien",
+  "Bogenweichen",
+  "Stoesse",
+  "Bytes gelesen (ST3)",
+  "Bytes geschrieben (ST3)",
+  "Cache unverbogene Weichen: Treffer",
+  "Cache unverbogene Weichen: Fehlschlaege",
+  "Cache LS3-Biegeparameter: Treffer",
+  "Cache LS3-Biegeparameter: Fehlschlaege",
+};
+static_assert(sizeof(zaehlernamen) / sizeof(zaehlernamen[0]) == static_cast<size_t>(Zaehler::ANZAHL));
+
+#ifdef PROFIL_WINDOWS
+uint64_t FiletimeNs(const FILETIME& zeit) {
+  return ((static_cast<uint64_t>(zeit.dwHighDateTime) << 32) | zeit.dwLowDateTime) * 100;
+}
+#endif
+
+// CPU-Zeit des gesamten Prozesses (alle Threads) in Nanosekunden
+uint64_t ProzessCpuZeitNs() {
+#if defined(PROFIL_POSIX)
+  timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+#elif defined(PROFIL_WINDOWS)
+  FILETIME erzeugt, beendet, kernel, benutzer;
+  if (GetProcessTimes(GetCurrentProcess(), &erzeugt, &beendet, &kernel, &benutzer)) {
+    return FiletimeNs(kernel) + FiletimeNs(benutzer);
+  }
+#endif
+  return 0;
+}
+
+// Maximaler Speicherbedarf (Resident Set Size) des Prozesses in Bytes
+uint64_t MaximalerSpeicherbedarf() {
+#if defined(PROFIL_POSIX)
+  rusage nutzung;
+  if (getrusage(RUSAGE_SELF, &nutzung) == 0) {
+#ifdef __APPLE__
+    return static_cast<uint64_t>(nutzung.ru_maxrss);
+#else
+    return static_cast<uint64_t>(nutzung.ru_maxrss) * 1024;
+#endif
+  }
+#elif defined(PROFIL_WINDOWS)
+  PROCESS_MEMORY_COUNTERS zaehler;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &zaehler, sizeof(zaehler))) {
+    return zaehler.PeakWorkingSetSize;
+  }
+#endif
+  return 0;
+}
+
+double Millisekunden(uint64_t ns) {
+  return ns / 1e6;
+}
+
+// Ein Abschnitt der Zeitleiste (Chrome-Trace-Ereignis vom Typ "X")
+struct Traceereignis {
+  std::string name;
+  const char* kategorie;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point ende;
+  std::string argumente;  // Inhalt des JSON-Objekts "args"
+};
+
+// Aufgezeichnete Ereignisse eines Threads. Nur der Thread selbst haengt an, gelesen wird erst am Programmende.
+struct Tracethread {
+  size_t id;
+  std::vector<Traceereignis> ereignisse;
+};
+
+std::mutex traceMutex;
+std::vector<std::unique_ptr<Tracethread>> traceThreads;
+thread_local Tracethread* aktuellerTracethread = nullptr;
+thread_local Tracespanne* innersteTracespanne = nullptr;
+
+Tracethread& AktuellerTracethread() {
+  if (!aktuellerTracethread) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceThreads.push_back(std::make_unique<Tracethread>());
+    traceThreads.back()->id = traceThreads.size();
+    aktuellerTracethread = traceThreads.back().get();
+  }
+  return *aktuellerTracethread;
+}
+
+void SchreibeJsonString(std::ostream& ausgabe, std::string_view text) {
+  constexpr char hex[] = "0123456789abcdef";
+  ausgabe << '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      ausgabe << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ausgabe << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+    } else {
+      ausgabe << c;
+    }
+  }
+  ausgabe << '"';
+}
+
+void HaengeArgumentAn(std::string& argumente, std::string_view name, std::string_view jsonWert) {
+  std::ostringstream ausgabe;
+  if (!argumente.empty()) {
+    ausgabe << ',';
+  }
+  SchreibeJsonString(ausgabe, name);
+  ausgabe << ':' << jsonWert;
+  argumente += ausgabe.str();
+}
+
+std::string JsonString(std::string_view text) {
+  std::ostringstream ausgabe;
+  SchreibeJsonString(ausgabe, text);
+  return ausgabe.str();
+}
+
+}  // namespace
+
+std::chrono::steady_clock::time_point Profil::s_start = std::chrono::steady_clock::now();
+Profil::Phasenstatistik Profil::s_phasen[static_cast<size_t>(Phase::ANZAHL)];
+std::atomic<uint64_t> Profil::s_zaehler[static_cast<size_t>(Zaehler::ANZAHL)] = {};
+
+void Profil::Aktiviere() {
+  s_aktiv = true;
+}
+
+void Profil::AktiviereTrace() {
+  s_trace = true;
+  AktuellerTracethread();  // Der aufrufende Thread bekommt die erste Nummer
+}
+
+void Profil::Erfasse(Phase phase, std::chrono::steady_clock::time_point start, uint64_t wandzeitNs, uint64_t cpuZeitNs) {
+  auto& statistik = s_phasen[static_cast<size_t>(phase)];
+  statistik.aufrufe.fetch_add(1, std::memory_order_relaxed);
+  statistik.wandzeitNs.fetch_add(wandzeitNs, std::memory_order_relaxed);
+  statistik.cpuZeitNs.fetch_add(cpuZeitNs, std::memory_order_relaxed);
+  if (s_trace) {
+    std::string argumente;
+    HaengeArgumentAn(argumente, "CPU-Zeit [ms]", std::to_string(Millisekunden(cpuZeitNs)));
+    ErfasseSpanne("phase", phasennamen[static_cast<size_t>(phase)], std::move(argumente),
+        start, start + std::chrono::nanoseconds(wandzeitNs));
+  }
+}
+
+void Profil::ErfasseSpanne(const char* kategorie, std::string name, std::string argumente,
+    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point ende) {
+  AktuellerTracethread().ereignisse.push_back(Traceereignis { std::move(name), kategorie, start, ende, std::move(argumente) });
+}
+
+uint64_t Profil::ThreadCpuZeitNs() {
+#if defined(PROFIL_POSIX)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+#elif defined(PROFIL_WINDOWS)
+  FILETIME erzeugt, beendet, kernel, benutzer;
+  if (GetThreadTimes(GetCurrentThread(), &erzeugt, &beendet, &kernel, &benutzer)) {
+    return FiletimeNs(kernel) + FiletimeNs(benutzer);
+  }
+#endif
+  return 0;
+}
+
+void Profil::Ausgeben(std::ostream& ausgabe) {
+  const auto gesamt = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_start);
+  const auto flags = ausgabe.flags();
+  const auto precision = ausgabe.precision();
+
+  ausgabe << "\nProfil (Zeiten in ms, je Phase summiert ueber alle Aufrufe):\n";
+  ausgabe << std::left << std::setw(26) << "Phase" << std::right << std::setw(10) << "Aufrufe"
+    << std::setw(12) << "Wandzeit" << std::setw(12) << "CPU-Zeit" << "\n";
+  ausgabe << std::fixed << std::setprecision(1);
+  for (size_t i = 0; i < static_cast<size_t>(Phase::ANZAHL); ++i) {
+    const auto& statistik = s_phasen[i];
+    if (statistik.aufrufe == 0) {
+      continue;
+    }
+    ausgabe << std::left << std::setw(26) << phasennamen[i] << std::right << std::setw(10) << statistik.aufrufe.load()
+      << std::setw(12) << Millisekunden(statistik.wandzeitNs) << std::setw(12) << Millisekunden(statistik.cpuZeitNs) << "\n";
+  }
+  ausgabe << std::left << std::setw(26) << "Gesamt (Prozess)" << std::right << std::setw(10) << ""
+    << std::setw(12) << Millisekunden(gesamt.count()) << std::setw(12) << Millisekunden(ProzessCpuZeitNs()) << "\n";
+
+  for (size_t i = 0; i < static_cast<size_t>(Zaehler::ANZAHL); ++i) {
+    ausgabe << zaehlernamen[i] << ": " << s_zaehler[i].load() << "\n";
+  }
+  ausgabe << "Maximaler Speicherbedarf: " << (MaximalerSpeicherbedarf() / (1024.0 * 1024.0)) << " MB\n";
+
+  ausgabe.flags(flags);
+  ausgabe.precision(precision);
+}
+
+bool Profil::SchreibeTrace(const std::string& dateiname) {
+  std::ofstream ausgabe(dateiname, std::ios::binary);
+  if (!ausgabe) {
+    return false;
+  }
+  const auto mikrosekunden = [](std::chrono::steady_clock::duration dauer) {
+    return std::chrono::duration<double, std::micro>(dauer).count();
+  };
+
+  std::lock_guard<std::mutex> lock(traceMutex);
+  ausgabe << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  ausgabe << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"radius_bogenweichen\"}}";
+  ausgabe << std::fixed << std::setprecision(3);
+  for (const auto& thread : traceThreads) {
+    ausgabe << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id << ",\"args\":{\"name\":"
+      << (thread->id == 1 ? "\"Hauptthread\"" : "\"Thread " + std::to_string(thread->id) + "\"") << "}}";
+    for (const auto& ereignis : thread->ereignisse) {
+      ausgabe << ",\n{\"name\":";
+      SchreibeJsonString(ausgabe, ereignis.name);
+      ausgabe << ",\"cat\":\"" << ereignis.kategorie << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+        << ",\"ts\":" << mikrosekunden(ereignis.start - s_start) << ",\"dur\":" << mikrosekunden(ereignis.ende - ereignis.start)
+        << ",\"args\":{" << ereignis.argumente << "}}";
+    }
+  }
+  ausgabe << "\n]}\n";
+  return static_cast<bool>(ausgabe.flush());
+}
+
+Tracespanne::Tracespanne(const char* kategorie, std::string_view name) : m_aktiv(Profil::traceAktiv()) {
+  if (m_aktiv) {
+    m_kategorie = kategorie;
+    m_name = name;
+    m_aussen = innersteTracespanne;
+    innersteTracespanne = this;
+    m_start = std::chrono::steady_clock::now();
+  }
+}
+
+Tracespanne::Tracespanne(const char* kategorie, std::string_view name, int64_t nummer) : Tracespanne(kategorie, name) {
+  if (m_aktiv) {
+    m_name += ' ';
+    m_name += std::to_string(nummer);
+    Argument("Nr", nummer);
+  }
+}
+
+Tracespanne::~Tracespanne() {
+  if (m_aktiv) {
+    Profil::ErfasseSpanne(m_kategorie, std::move(m_name), std::move(m_argumente), m_start, std::chrono::steady_clock::now());
+    innersteTracespanne = m_aussen;
+  }
+}
+
+void Tracespanne::Argument(std::string_view name, std::string_view wert) {
+  if (m_aktiv) {
+    HaengeArgumentAn(m_argumente, name, JsonString(wert));
+  }
+}
+
+void Tracespanne::Argument(std::string_view name, int64_t wert) {
+  if (m_aktiv) {
+    HaengeArgumentAn(m_argumente, name, std::to_string(wert));
+  }
+}
+
+void Tracespanne::ArgumentAktuell(std::string_view name, std::string_view wert) {
+  if (innersteTracespanne) {
+    innersteTracespanne->Argument(name, wert);
+  }
+}
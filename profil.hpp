@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Programmphasen, deren Laufzeit mit --profile gemessen wird.
+// Phasen koennen verschachtelt sein (z.B. Originalweiche enthaelt das Einlesen der unverbogenen Weiche),
+// die Zeiten sind dann jeweils inklusive der inneren Phasen.
+enum class Phase {
+  Weichenzuordnung,      // GetWeichenMapping
+  StreckendateiLesen,    // LiesStreckendatei (bearbeitete Streckendateien und unverbogene Weichen)
+  Verknuepfen,           // VerknuepfeNeu (--verknuepfen)
+  FindeWeichen,          // Streckengraph und FindeWeichen der bearbeiteten Streckendateien
+  Geometrietabelle,
+  OriginalweicheSuchen,  // unverbogene Weiche im Zwischenspeicher suchen, einschliesslich Laden oder Warten darauf
+  Originalweiche,        // Laden der unverbogenen Weiche (Einlesen und FindeWeichen), nur bei Cache-Fehlschlag
+  LS3Suchen,             // Biegeparameter der LS3-Datei im Zwischenspeicher suchen, einschliesslich Laden oder Warten
+  LS3Lesen,              // Einlesen der verbogenen LS3-Datei, nur bei Cache-Fehlschlag
+  Biegeparameter,        // LiesBiegeparameter bzw. BerechneBiegeparameter
+  KruemmungKorrigieren,  // KorrigiereKruemmungAbzweigenderStrang
+  Knickpruefung,         // FindeKnicke (-k)
+  Schreiben,             // SchreibeNeueKruemmungen
+  ANZAHL,
+};
+
+// Ereigniszaehler fuer --profile
+enum class Zaehler {
+  Streckendateien,   // eingelesene Streckendateien (ohne unverbogene Weichen)
+  Bogenweichen,      // in den Streckendateien gefundene Bogenweichen
+  Stoesse,           // bei der Knickpruefung gepruefte Stoesse
+  BytesGelesen,      // Groesse aller eingelesenen ST3-Dateien
+  BytesGeschrieben,  // Groesse aller geschriebenen ST3-Dateien
+  // Am Programmende aus dem Zwischenspeicher uebernommen
+  OriginalweichenTreffer,
+  OriginalweichenFehlschlaege,
+  BiegeparameterTreffer,
+  BiegeparameterFehlschlaege,
+  ANZAHL,
+};
+
+// Sammelt Laufzeiten und Zaehler eines Programmlaufs (--profile) und zeichnet auf Wunsch alle Phasen
+// und Tracespannen als Zeitleiste pro Thread auf (--trace). Ist beides nicht aktiviert, kostet eine
+// Messung nur die Abfrage von Profil::messungAktiv().
+// Die CPU-Zeit einer Phase ist die des Threads, der die Phase ausfuehrt; Arbeit, die die Phase auf andere
+// Threads des Arbeitspools verteilt, zaehlt nur zur CPU-Zeit des gesamten Prozesses.
+// Laufen Phasen parallel, werden ihre Wandzeiten addiert und koennen die Gesamtlaufzeit uebersteigen.
+class Profil {
+ public:
+  // Aktiviere und AktiviereTrace muessen vor dem Start weiterer Threads aufgerufen werden.
+  static void Aktiviere();
+  static bool aktiv() { return s_aktiv; }
+  static void AktiviereTrace();
+  static bool traceAktiv() { return s_trace; }
+  static bool messungAktiv() { return s_aktiv || s_trace; }
+
+  static void Zaehle(Zaehler zaehler, uint64_t anzahl = 1) {
+    if (s_aktiv) {
+      s_zaehler[static_cast<size_t>(zaehler)].fetch_add(anzahl, std::memory_order_relaxed);
+    }
+  }
+
+  static void Erfasse(Phase phase, std::chrono::steady_clock::time_point start, uint64_t wandzeitNs, uint64_t cpuZeitNs);
+
+  // Gibt Phasen, Zaehler, Gesamtlaufzeit und maximalen Speicherbedarf aus.
+  static void Ausgeben(std::ostream& ausgabe);
+
+  // Schreibt die aufgezeichneten Phasen und Tracespannen im Chrome Trace Event Format
+  // (lesbar von Perfetto und chrome://tracing). Darf erst aufgerufen werden, wenn keine Messung mehr laeuft.
+  static bool SchreibeTrace(const std::string& dateiname);
+
+  // CPU-Zeit des aufrufenden Threads in Nanosekunden (0, wenn auf dieser Plattform nicht verfuegbar)
+  static uint64_t ThreadCpuZeitNs();
+
+ private:
+  struct Phasenstatistik {
+    std::atomic<uint64_t> aufrufe { 0 };
+    std::atomic<uint64_t> wandzeitNs { 0 };
+    std::atomic<uint64_t> cpuZeitNs { 0 };
+  };
+
+  friend class Tracespanne;
+
+  static void ErfasseSpanne(const char* kategorie, std::string name, std::string argumente,
+      std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point ende);
+
+  static inline bool s_aktiv = false;
+  static inline bool s_trace = false;
+  static std::chrono::steady_clock::time_point s_start;
+  static Phasenstatistik s_phasen[static_cast<size_t>(Phase::ANZAHL)];
+  static std::atomic<uint64_t> s_zaehler[static_cast<size_t>(Zaehler::ANZAHL)];
+};
+
+// Misst eine Phase von der Konstruktion bis zum Ende des Gueltigkeitsbereichs, z.B.
+//   { Phasenmessung messung(Phase::Schreiben); SchreibeNeueKruemmungen(...); }
+class Phasenmessung {
+ public:
+  explicit Phasenmessung(Phase phase) : m_phase(phase), m_aktiv(Profil::messungAktiv()) {
+    if (m_aktiv) {
+      m_start = std::chrono::steady_clock::now();
+      m_cpuStart = Profil::ThreadCpuZeitNs();
+    }
+  }
+
+  Phasenmessung(const Phasenmessung&) = delete;
+  Phasenmessung& operator=(const Phasenmessung&) = delete;
+
+  ~Phasenmessung() {
+    if (m_aktiv) {
+      const auto wandzeit = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+      Profil::Erfasse(m_phase, m_start, static_cast<uint64_t>(wandzeit.count()), Profil::ThreadCpuZeitNs() - m_cpuStart);
+    }
+  }
+
+ private:
+  Phase m_phase;
+  bool m_aktiv;
+  std::chrono::steady_clock::time_point m_start;
+  uint64_t m_cpuStart = 0;
+};
+
+// Benannter Abschnitt in der Zeitleiste von --trace, z.B. eine Streckendatei oder eine Bogenweiche.
+// Argumente koennen bis zum Ende der Spanne ergaenzt werden, aus aufgerufenen Funktionen auch ueber
+// ArgumentAktuell, das sich auf die innerste offene Tracespanne des Threads bezieht.
+// Ohne --trace wird nichts aufgezeichnet.
+class Tracespanne {
+ public:
+  Tracespanne(const char* kategorie, std::string_view name);
+  // Name "<name> <nummer>", zusaetzlich Argument "Nr"
+  Tracespanne(const char* kategorie, std::string_view name, int64_t nummer);
+  Tracespanne(const Tracespanne&) = delete;
+  Tracespanne& operator=(const Tracespanne&) = delete;
+  ~Tracespanne();
+
+  void Argument(std::string_view name, std::string_view wert);
+  void Argument(std::string_view name, int64_t wert);
+
+  static void ArgumentAktuell(std::string_view name, std::string_view wert);
+
+ private:
+  bool m_aktiv;
+  const char* m_kategorie = nullptr;
+  std::string m_name;
+  std::string m_argumente;  // Inhalt des JSON-Objekts "args"
+  std::chrono::steady_clock::time_point m_start;
+  Tracespanne* m_aussen = nullptr;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ostream>
+
+// Ausfuehrlichkeit der Programmausgabe
+enum class Ausgabestufe {
+  Zusammenfassung,  // nur die Zusammenfassung am Ende
+  Fehler,           // zusaetzlich Fehler und Warnungen (-q)
+  Normal,           // zusaetzlich Fortschritt pro Bogenweiche (Standard)
+  Ausfuehrlich,     // zusaetzlich Elementlisten, Knickwinkel und Biegeparameter (-v)
+};
+
+// Ausgabeziel mit Ausfuehrlichkeitsstufe.
+// Meldungen einer Stufe werden nur mit vorgeschalteter Abfrage geschrieben, z.B.
+//   if (log.ausfuehrlich()) { log << ...; }
+// damit fuer abgeschaltete Meldungen weder formatiert noch etwas berechnet wird.
+class Protokoll {
+ public:
+  Protokoll(std::ostream& ausgabe, Ausgabestufe stufe) : m_ausgabe(ausgabe), m_stufe(stufe) {}
+
+  Ausgabestufe stufe() const { return m_stufe; }
+  bool fehler() const { return m_stufe >= Ausgabestufe::Fehler; }
+  bool normal() const { return m_stufe >= Ausgabestufe::Normal; }
+  bool ausfuehrlich() const { return m_stufe >= Ausgabestufe::Ausfuehrlich; }
+
+  template<typename T>
+  Protokoll& operator<<(const T& wert) {
+    m_ausgabe << wert;
+    return *this;
+  }
+
+  Protokoll& operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+    m_ausgabe << manipulator;
+    return *this;
+  }
+
+ private:
+  std::ostream& m_ausgabe;
+  Ausgabestufe m_stufe;
+};
@@ -1,130 +1,58 @@
 #include "zusi_parser/zusi_types.hpp"
 #include "zusi_parser/utils.hpp"
 
+#include "arbeitspool.hpp"
+#include "bogenweichen.hpp"
+#include "elementspeicher.hpp"
+#include "geometrietabelle.hpp"
+#include "knickpruefung.hpp"
+#include "kruemmungstabelle.hpp"
+#include "mustersuche.hpp"
+#include "profil.hpp"
+#include "protokoll.hpp"
+#include "streckendatei.hpp"
+#include "streckengraph.hpp"
+#include "verknuepfung.hpp"
+
+#include <atomic>
+#include <charconv>
 #include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
-#include "rapidxml-1.13/rapidxml.hpp"
-#include "rapidxml-1.13/rapidxml_print.hpp"
+// Zuordnung von Namensmustern verbogener Weichen zu den ST3-Dateien der unverbogenen Weichen.
+struct Weichenzuordnung {
+  std::vector<std::pair<std::string, std::string>> eintraege;  // (Muster, Zusi-Pfad der unverbogenen Weiche)
+  Mustersuche suche;  // ueber die Muster aller Eintraege
 
-using ElementUndRichtung = std::pair<const StrElement*, bool>;
-
-double GetKruemmung(const ElementUndRichtung& ER) {
-  return ER.second ? ER.first->kr : -ER.first->kr;
-}
-
-size_t GetAnzahlNachfolger(const ElementUndRichtung& ER) {
-  return ER.second ? ER.first->children_NachNorm.size() : ER.first->children_NachGegen.size();
-}
-
-double HundertstelGrad(double rad) {
-  return 100 * (rad * 180.0 / M_PI);
-}
-
-ElementUndRichtung GetNachfolger(const Strecke& str, ElementUndRichtung el, size_t idx) {
-  const auto& nachfolgerArray = (el.second ? el.first->children_NachNorm : el.first->children_NachGegen);
-  const auto& anschlussMask = (el.second ? 0x1 : 0x100) << idx;
-
-  if (idx >= nachfolgerArray.size()) {
-    return { nullptr, false };
-  }
-  const auto& nachfolgerNr = nachfolgerArray[idx].Nr;
-  if (nachfolgerNr < 0 || static_cast<size_t>(nachfolgerNr) >= str.children_StrElement.size() || !str.children_StrElement[nachfolgerNr]) {
-    return { nullptr, false };
+  // Gibt die Indizes aller Eintraege zurueck, deren Muster in `dateiname` vorkommt,
+  // in der Reihenfolge aus weichen.txt.
+  std::vector<size_t> Finde(std::string_view dateiname) const {
+    return suche.Finde(dateiname);
   }
-  return { str.children_StrElement[nachfolgerNr].get(), (el.first->Anschluss & anschlussMask) == 0 };
-}
-
-constexpr size_t WEICHE = 1 << 2;
-
-struct Weiche {
-  const Signal* weichensignal;
-  ElementUndRichtung startElement;
-  std::vector<ElementUndRichtung> geraderStrang;
-  std::vector<ElementUndRichtung> abzweigenderStrang;
 };
 
-std::vector<Weiche> FindeWeichen(const Strecke& str, bool nurBogenweichen = false) {
-  std::vector<Weiche> result;
-
-  const auto getNachfolger = [&str](const ElementUndRichtung& el, size_t idx) {
-    return GetNachfolger(str, el, idx);
-  };
-  const auto folgeWeichenstrang = [&str, &getNachfolger](const ElementUndRichtung& el) -> std::vector<ElementUndRichtung> {
-    std::vector<ElementUndRichtung> result;
-    ElementUndRichtung cur = el;
-    while (cur.first && (GetAnzahlNachfolger(cur) <= 1) && (cur.first->Fkt & WEICHE)) {
-      result.push_back(cur);
-      cur = getNachfolger(cur, 0);
-    }
-    return result;
-  };
-
-  for (const auto& str_element : str.children_StrElement) {
-    if (!str_element) {
-      continue;
-    }
-
-    if ((str_element->Fkt & WEICHE) &&
-        (str_element->children_NachNorm.size() == 2 || str_element->children_NachGegen.size() == 2)) {
-
-      const bool norm = (str_element->children_NachNorm.size() == 2);
-
-      const auto& richtungsInfo = (norm ? str_element->InfoNormRichtung : str_element->InfoGegenRichtung);
-      if (!richtungsInfo.has_value()) {
-        std::cout << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber enthaelt keine Richtungsinformation\n";
-        continue;
-      }
-
-      const auto& signal = richtungsInfo->Signal;
-      if (!signal) {
-        std::cout << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber enthaelt kein Signal\n";
-        continue;
-      }
-      if (signal->children_SignalFrame.empty()) {
-        std::cout << "!! Element " << str_element->Nr << " hat mehr als einen Nachfolger, aber das Signal enthaelt keine Signalframes\n";
-        continue;
-      }
-
-      const auto& signalFrame = signal->children_SignalFrame[0];
-      const auto& dateiname = signalFrame->Datei.Dateiname;
-
-      if (nurBogenweichen && (dateiname.find("gebogen") == std::string::npos)) {
-        continue;
-      }
-
-      if ((dateiname.find("DKW") != std::string::npos)
-          || (dateiname.find("EKW") != std::string::npos)
-          || (dateiname.find("symm ABW") != std::string::npos)
-          || (dateiname.find("symm_ABW") != std::string::npos)
-          || (dateiname.find("WA-WM") != std::string::npos)
-          || (dateiname.find("Zunge") != std::string::npos)
-          || (dateiname.find("ZDW") != std::string::npos)) {
-        continue;
-      }
-
-      result.push_back(Weiche {
-          signal.get(),
-          { str_element.get(), norm },
-          folgeWeichenstrang(getNachfolger({str_element.get(), norm}, 0)),
-          folgeWeichenstrang(getNachfolger({str_element.get(), norm}, 1)) });
-    }
-  }
-
-  return result;
-}
-
-std::vector<std::pair<std::string, std::string>> GetWeichenMapping() {
+Weichenzuordnung GetWeichenMapping(Protokoll& log) {
   std::vector<std::pair<std::string, std::string>> result;
 
-  std::cout << "Lies Weichenzuordnung aus weichen.txt\n";
+  if (log.normal()) {
+    log << "Lies Weichenzuordnung aus weichen.txt\n";
+  }
   std::ifstream infile("weichen.txt");
   if (!infile) {
-    std::cout << "Fehler beim Laden von weichen.txt\n";
+    if (log.fehler()) {
+      log << "Fehler beim Laden von weichen.txt\n";
+    }
   }
   std::string line;
   while (std::getline(infile, line)) {
@@ -166,7 +94,9 @@ std::vector<std::pair<std::string, std::string>> GetWeichenMapping() {
       }
     }
 
-    std::cout << pattern << " -> " << datei << "\n";
+    if (log.ausfuehrlich()) {
+      log << pattern << " -> " << datei << "\n";
+    }
     if (patternUnterstrich != pattern) {
       result.emplace_back(std::move(patternUnterstrich), datei);
     }
@@ -179,415 +109,682 @@ std::vector<std::pair<std::string, std::string>> GetWeichenMapping() {
     result.emplace_back(std::move(pattern), std::move(datei));
   };
 
-  return result;
+  std::vector<std::string_view> muster;
+  muster.reserve(result.size());
+  for (const auto& eintrag : result) {
+    muster.emplace_back(eintrag.first);
+  }
+  Mustersuche suche(muster);
+  return Weichenzuordnung { std::move(result), std::move(suche) };
 }
 
-double ElementLaenge(const StrElement& el) {
-  return std::hypot(el.b.X - el.g.X, el.b.Y - el.g.Y, el.b.Z - el.g.Z);
-}
+// Threadsicherer Zwischenspeicher, der den Wert zu einem Schluessel hoechstens einmal pro Programmlauf berechnet.
+// Fragen mehrere Threads gleichzeitig denselben Schluessel an, wartet einer auf die Berechnung des anderen.
+template<typename Schluessel, typename Wert, typename Hash = std::hash<Schluessel>>
+class Cache {
+ public:
+  template<typename Laden>
+  const Wert& Get(const Schluessel& schluessel, Laden&& laden) {
+    Eintrag* eintrag;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto& slot = m_eintraege[schluessel];
+      if (slot) {
+        ++m_treffer;
+      } else {
+        slot = std::make_unique<Eintrag>();
+        ++m_fehlschlaege;
+      }
+      eintrag = slot.get();
+    }
+    std::call_once(eintrag->geladen, [&]() { eintrag->wert = laden(schluessel); });
+    return eintrag->wert;
+  }
 
-double Radius(double kr) {
-  return kr == 0.0f ? std::numeric_limits<double>::infinity() : 1/kr;
-}
+  size_t Treffer() const { return m_treffer; }
+  size_t Fehlschlaege() const { return m_fehlschlaege; }
+
+ private:
+  struct Eintrag {
+    std::once_flag geladen;
+    Wert wert;
+  };
 
-enum class ElementEnde {
-  Anfang, Ende
+  std::mutex m_mutex;
+  std::unordered_map<Schluessel, std::unique_ptr<Eintrag>, Hash> m_eintraege;
+  std::atomic<size_t> m_treffer { 0 };
+  std::atomic<size_t> m_fehlschlaege { 0 };
 };
 
-const Vec3& GetElementEnde(const ElementUndRichtung& elementRichtung, ElementEnde ende) {
-  return (elementRichtung.second == (ende == ElementEnde::Anfang)) ? elementRichtung.first->g : elementRichtung.first->b;
-}
+// Unverbogene Weiche aus weichen.txt. Die Zeiger in `weichen` verweisen in `st3`.
+struct Originalweiche {
+  std::unique_ptr<Streckendatei> st3;
+  std::vector<Weiche> weichen;
+  Geometrietabelle geometrie;
+  std::string log;  // Ausgaben von FindeWeichen, werden bei jeder Verwendung wiederholt
+};
 
-double WinkelDiff(double phi1, double phi2) {
-  // phi1, phi2 sind im Intervall [-π, π]
-  auto result = phi1 - phi2;  // im Intervall [-2π, 2π]
-  result = std::abs(result);  // im Intervall [0, 2π]
-  result = result - M_PI;     // im Intervall [-π, π]
-  result = std::abs(result);  // im Intervall [0, π]
-  result = M_PI - result;     // im Intervall [0, π]
+Originalweiche LadeOriginalweiche(const std::string& pfad, Ausgabestufe stufe) {
+  Phasenmessung messung(Phase::Originalweiche);
+  Originalweiche result;
+  std::ostringstream ausgabe;
+  Protokoll log(ausgabe, stufe);
+  // Nur die Weichenelemente werden gebraucht, daher wie die Streckendatei selbst einlesen.
+  // Lesefehler werden nur als "Fehler beim Parsen" gemeldet.
+  {
+    Phasenmessung messungLesen(Phase::StreckendateiLesen);
+    result.st3 = LiesStreckendatei(zusixml::ZusiPfad::vonZusiPfad(pfad).alsOsPfad(), Leseoptionen {}, log);
+  }
+  if (result.st3 && result.st3->zusi->Strecke) {
+    const auto& strecke = *result.st3->zusi->Strecke;
+    result.weichen = FindeWeichen(strecke, Streckengraph(strecke), log);
+    result.geometrie = Geometrietabelle(strecke);
+    result.log = ausgabe.str();
+  }
   return result;
-  // return M_PI - std::abs(std::abs(phi1 - phi2) - M_PI);
 }
 
-bool LinksVon(double phi1, double phi2) {
-  const auto diff = phi1 - phi2;
-  return (diff > 0) || (diff < -M_PI);
-}
+// Aus der Dateibeschreibung einer verbogenen LS3-Datei gelesene Biegeparameter.
+struct LS3Biegeparameter {
+  std::vector<std::pair<double, double>> werte;
+  std::string log;  // Ausgaben von LiesBiegeparameter, werden bei jeder Verwendung wiederholt
+};
 
-double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende, double kr /* in Normrichtung */) {
-  const auto& p1 = GetElementEnde(elementRichtung, ElementEnde::Anfang);
-  const auto& p2 = GetElementEnde(elementRichtung, ElementEnde::Ende);
-  double result = atan2(p2.Y - p1.Y, p2.X - p1.X);  // Winkel ohne Kruemmung
-
-  if (std::abs(kr) >= 1/100000.0) {
-    if (!elementRichtung.second) {
-      kr = -kr;
-    }
-    const double radius = 1.0/kr;
-    // Element repraesentiert eine Kreissehne im Kreis mit Radius `radius`
-    // Berechne Sehnenwinkel alpha und daraus Winkel der Kreistangente
-    //  alpha = 2 * asin(l / 2 * radius)
-    //  tangentenwinkel = alpha / 2
-    const double tangentenwinkel = asin(ElementLaenge(*elementRichtung.first) / (2.0 * std::abs(radius)));
-
-    if ((kr > 0) == (ende == ElementEnde::Anfang)) {
-      // Positive Kruemmung: Linksbogen -> erst Ausschlag nach rechts, also gegen Uhrzeigersinn
-      result -= tangentenwinkel;
-    } else {
-      result += tangentenwinkel;
-    }
+// Schluessel: Betriebssystem-Pfad der LS3-Datei und Laenge des Verzweigungselements
+using LS3BiegeparameterSchluessel = std::pair<std::string, double>;
+
+struct LS3BiegeparameterSchluesselHash {
+  size_t operator()(const LS3BiegeparameterSchluessel& schluessel) const {
+    return std::hash<std::string>()(schluessel.first) ^ (std::hash<double>()(schluessel.second) << 1);
   }
+};
 
+LS3Biegeparameter LadeBiegeparameter(const LS3BiegeparameterSchluessel& schluessel, Ausgabestufe stufe) {
+  LS3Biegeparameter result;
+  std::ostringstream ausgabe;
+  Protokoll log(ausgabe, stufe);
+  std::unique_ptr<Zusi> ls3Verbogen;
+  {
+    Phasenmessung messung(Phase::LS3Lesen);
+    ls3Verbogen = zusixml::parseFile(schluessel.first);
+  }
+  if (ls3Verbogen) {
+    Phasenmessung messung(Phase::Biegeparameter);
+    result.werte = LiesBiegeparameter(*ls3Verbogen, schluessel.second, log);
+  } else if (log.fehler()) {
+    log << "Fehler beim Einlesen\n";
+  }
+  result.log = ausgabe.str();
   return result;
 }
 
-double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende) {
-  return GetWinkel(elementRichtung, ende, elementRichtung.first->kr);
+// Ueber alle Streckendateien eines Programmlaufs geteilte Zwischenergebnisse.
+struct Zwischenspeicher {
+  Cache<std::string, Originalweiche> originalweichen;  // Schluessel: Zusi-Pfad der ST3-Datei
+  Cache<LS3BiegeparameterSchluessel, LS3Biegeparameter, LS3BiegeparameterSchluesselHash> biegeparameter;
+};
+
+struct Optionen {
+  std::optional<int> nurStartelement;  // Nur die Bogenweiche mit diesem Startelement bearbeiten
+  Leseoptionen leseoptionen;
+  Ausgabestufe ausgabestufe = Ausgabestufe::Normal;
+  std::optional<double> knickSchwelle;  // Knickpruefung statt Bogenweichenkorrektur, Schwelle in Grad
+  std::optional<double> verknuepfungsToleranz;  // Streckennetz vor der Bearbeitung neu verknuepfen, Toleranz in m
+};
+
+void PrintElemente(const Geometrietabelle& geometrie, const ElementUndRichtung& startElement, const std::vector<ElementUndRichtung>& elemente, Protokoll& log) {
+  if (!log.ausfuehrlich()) {
+    return;
+  }
+  for (size_t i = 0, len = elemente.size() + 1; i < len; ++i) {
+    const auto& el = (i == 0 ? startElement : elemente[i - 1]);
+    const auto kr = GetKruemmung(el);
+    log << " - " << el.first->Nr << ",l=" << geometrie.laenge(el.first->Nr) << ", kr=" << kr << "/r=" << Radius(kr);
+    if (i == 0) {
+      log << " (Verzweigungselement)";
+    }
+    log << "\n";
+    if (i < len - 1) {
+      const auto& el2 = elemente[i];
+      const auto winkelEl1Ende = GetWinkel(geometrie, el, ElementEnde::Ende);
+      const auto winkelEl2Anfang = GetWinkel(geometrie, el2, ElementEnde::Anfang);
+      // log << ", w1=" << winkelEl1Ende << ", w2=" << winkelEl2Anfang;
+      const auto knick = WinkelDiff(winkelEl1Ende, winkelEl2Anfang);
+      log << "  > Knick " << HundertstelGrad(knick) << "\n";
+    }
+  }
 }
 
-// Gibt einen Vektor mit derselben Laenge wie `vec` zurueck,
-// in dessen i-tem Element der Index des zum i-ten Element aus `vec` zugehoerigen Elementes aus `referenz` steht.
-// (Zuordnung erfolgt ueber die Elementlaengen)
-std::vector<size_t> BerechneElementZuordnung(const std::vector<ElementUndRichtung>& vec, const std::vector<ElementUndRichtung>& referenz) {
-  std::vector<size_t> result;
-  result.reserve(vec.size());
-  auto itReferenz = referenz.begin();
+// Berechnet die neuen Kruemmungen des abzweigenden Strangs einer Bogenweiche als Paare (Nr, kr).
+// Gibt 0 zurueck, wenn die Bogenweiche erfolgreich bearbeitet wurde, sonst 1.
+int BearbeiteBogenweiche(Weiche& bogenweiche,  // non-const wg. std::swap(geraderStrang, abzweigenderStrang)
+    const Geometrietabelle& geometrie,  // der Strecke, in der die Bogenweiche liegt
+    const Weichenzuordnung& OriginalWeichen,
+    Zwischenspeicher& zwischenspeicher,
+    std::vector<std::pair<std::size_t, double>>& kruemmungenNeu,
+    Protokoll& log) {
+  int result = 0;
+  if (bogenweiche.geraderStrang.empty() || bogenweiche.abzweigenderStrang.empty()) {
+    if (log.fehler()) {
+      log << "Im geraden oder abzweigenden Strang sind keine Elemente vorhanden. Wurde vergessen, nach dem ST3-Export das Streckennetz neu zu verknuepfen? (Option --verknuepfen)\n";
+    }
+    return 1;
+  }
+  const auto& signalframes = bogenweiche.weichensignal->children_SignalFrame;
+  const auto& itErsterSignalframe = std::find_if(signalframes.begin(), signalframes.end(),
+      [](const auto& signalframe) {
+        return std::abs(signalframe->p.X) < 0.0001
+          && std::abs(signalframe->p.Y) < 0.0001
+          && std::abs(signalframe->p.Z) < 0.0001;
+      });
+
+  if (itErsterSignalframe == signalframes.end()) {
+    if (log.fehler()) {
+      log << "Kein Signalframe an Position (0, 0, 0), unverbogene Weiche kann nicht ermittelt werden\n";
+    }
+    return 1;
+  }
 
-  constexpr double epsilon = 0.3;  // Erlaubte Laengenabweichung zwischen Original- und verbogenem Element
+  const auto& dateinameErsterSignalframe = (*itErsterSignalframe)->Datei.Dateiname;
+  if (log.normal()) {
+    log << "Erster Signalframe an Position (0,0,0):\n";
+    log << " - " << dateinameErsterSignalframe << "\n";
+  }
 
-  double ldiff = -ElementLaenge(*itReferenz->first);  // Lauflaenge vec - Lauflaenge referenz
-  for (size_t i = 0, len = vec.size(); i < len; ++i) {
-    const auto& el = vec[i];
+  if (log.ausfuehrlich()) {
+    log << "Elemente in Strang 1:\n";
+    PrintElemente(geometrie, bogenweiche.startElement, bogenweiche.geraderStrang, log);
+    log << "Elemente in Strang 2:\n";
+    PrintElemente(geometrie, bogenweiche.startElement, bogenweiche.abzweigenderStrang, log);
+  }
 
-    assert(itReferenz != referenz.end());
-    result.push_back(itReferenz - referenz.begin());
+  // Originaldatei herausfinden
+  bool found = false;
+  for (const size_t idx : OriginalWeichen.Finde(dateinameErsterSignalframe)) {
+    const auto& it = OriginalWeichen.eintraege[idx];
+    if (log.normal()) {
+      log << "Unverbogene Weiche: " << it.second << "\n";
+    }
+    const auto& original = [&]() -> const Originalweiche& {
+      Phasenmessung messung(Phase::OriginalweicheSuchen);
+      return zwischenspeicher.originalweichen.Get(it.second,
+          [&log](const std::string& pfad) { return LadeOriginalweiche(pfad, log.stufe()); });
+    }();
+    if (!original.st3 || !original.st3->zusi->Strecke) {
+      result = 1;
+      if (log.fehler()) {
+        log << "Fehler beim Parsen\n";
+      }
+      continue;
+    }
 
-    ldiff += ElementLaenge(*el.first);
-    if (std::abs(ldiff) <= epsilon) {
-      ldiff = 0;
+    log << original.log;
+    const auto& originaldateiWeichen = original.weichen;
+    if (originaldateiWeichen.size() != 1) {
+      if (log.fehler()) {
+        log << "Nicht genau eine Weiche in der ST3-Datei gefunden\n";
+      }
+      result = 1;
+      continue;
+    }
+    const auto& originalweiche = originaldateiWeichen[0];
+    // Annahme: Erster Nachfolger der Originalweiche ist gerader Strang
+    if (log.ausfuehrlich()) {
+      log << "Elemente im geraden Strang:\n";
+      PrintElemente(original.geometrie, originalweiche.startElement, originalweiche.geraderStrang, log);
+      log << "Elemente im abzweigenden Strang:\n";
+      PrintElemente(original.geometrie, originalweiche.startElement, originalweiche.abzweigenderStrang, log);
     }
 
-    if (i < len - 1) {
-      while (ldiff > -epsilon) {
-        ++itReferenz;
-        assert(itReferenz != referenz.end());
-        ldiff -= ElementLaenge(*itReferenz->first);
+    if (!std::all_of(originalweiche.geraderStrang.begin(), originalweiche.geraderStrang.end(), [](const auto& elementRichtung) {
+          return std::abs(elementRichtung.first->kr) < 0.00001f;
+        })) {
+      if (log.fehler()) {
+        log << "Gerader Strang der unverbogenen Weiche hat nicht ueberall Kruemmung 0\n";
       }
+      result = 1;
+      continue;
     }
-  }
 
-  assert(ldiff > -epsilon);
+    // Herausfinden, welches der abzweigende Strang in der verbogenen Weiche ist
+    // (die Vorzugslage koennte geaendert worden sein)
+    // -> Vergleiche die Vorzeichen der Winkel (Ende gerader Strang) - (Startelement) - (Ende abzweigender Strang)
+    // fuer Original und Bogenweiche (beim Biegen wird die relative Lage der Streckenelemente zueinander nicht veraendert).
+    const auto& bogenweicheScheitel = GetElementEnde(bogenweiche.startElement, ElementEnde::Anfang);
+    const auto& bogenweicheP1 = GetElementEnde(bogenweiche.geraderStrang.back(), ElementEnde::Ende);
+    const auto& bogenweicheP2 = GetElementEnde(bogenweiche.abzweigenderStrang.back(), ElementEnde::Ende);
+
+    const auto& originalweicheScheitel = GetElementEnde(originalweiche.startElement, ElementEnde::Anfang);
+    const auto& originalweicheP1 = GetElementEnde(originalweiche.geraderStrang.back(), ElementEnde::Ende);
+    const auto& originalweicheP2 = GetElementEnde(originalweiche.abzweigenderStrang.back(), ElementEnde::Ende);
+
+    const auto winkelBogenweicheP1 = atan2(bogenweicheP1.Y - bogenweicheScheitel.Y, bogenweicheP1.X - bogenweicheScheitel.X);
+    const auto winkelBogenweicheP2 = atan2(bogenweicheP2.Y - bogenweicheScheitel.Y, bogenweicheP2.X - bogenweicheScheitel.X);
+    const auto winkelDiffBogenweiche = LinksVon(winkelBogenweicheP2, winkelBogenweicheP1);
+
+    const auto winkelOriginalweicheP1 = atan2(originalweicheP1.Y - originalweicheScheitel.Y, originalweicheP1.X - originalweicheScheitel.X);
+    const auto winkelOriginalweicheP2 = atan2(originalweicheP2.Y - originalweicheScheitel.Y, originalweicheP2.X - originalweicheScheitel.X);
+    const auto winkelDiffOriginalweiche = LinksVon(winkelOriginalweicheP2, winkelOriginalweicheP1);
+
+    if (winkelDiffBogenweiche != winkelDiffOriginalweiche) {
+      std::swap(bogenweiche.geraderStrang, bogenweiche.abzweigenderStrang);
+      if (log.normal()) {
+        log << "Strang 2 in Bogenweiche ist gerader Strang, Strang 1 ist abzweigender Strang\n";
+      }
+    } else {
+      if (log.normal()) {
+        log << "Strang 1 in Bogenweiche ist gerader Strang, Strang 2 ist abzweigender Strang\n";
+      }
+    }
 
-  return result;
-}
+    if (log.normal()) {
+      log << "Lies Bogenweichen-Parameter aus verbogener LS3-Datei " << dateinameErsterSignalframe << "\n";
+    }
+    const auto& ls3Biegeparameter = [&]() -> const LS3Biegeparameter& {
+      Phasenmessung messung(Phase::LS3Suchen);
+      return zwischenspeicher.biegeparameter.Get(
+          { zusixml::ZusiPfad::vonZusiPfad(dateinameErsterSignalframe).alsOsPfad(),
+            original.geometrie.laenge(originalweiche.startElement.first->Nr) },  // Laenge des Verzweigungselements soll nicht in Lauflaenge enthalten sein
+          [&log](const LS3BiegeparameterSchluessel& schluessel) { return LadeBiegeparameter(schluessel, log.stufe()); });
+    }();
+    log << ls3Biegeparameter.log;
+    std::vector<std::pair<double, double>> krdiffs = ls3Biegeparameter.werte;
+
+    if (krdiffs.empty()) {
+      if (log.normal()) {
+        log << "Berechne Bogenweichen-Parameter aus den Kruemmungsunterschieden des geraden Strangs\n";
+      }
+      Phasenmessung messung(Phase::Biegeparameter);
+      krdiffs = BerechneBiegeparameter(originalweiche.geraderStrang, original.geometrie, bogenweiche.geraderStrang, geometrie, log);
+    }
 
-std::vector<std::pair<double, double>> BerechneBiegeparameter(const std::vector<ElementUndRichtung>& unverbogen, const std::vector<ElementUndRichtung>& verbogen) {
-  std::vector<std::pair<double, double>> result;
-  result.reserve(verbogen.size());
+    if (log.normal()) {
+      log << "Wende Bogenweichen-Parameter auf abzweigenden Strang an\n";
+    }
+    Phasenmessung messung(Phase::KruemmungKorrigieren);
+    kruemmungenNeu = KorrigiereKruemmungAbzweigenderStrang(originalweiche.startElement, bogenweiche.startElement,
+        originalweiche.abzweigenderStrang, bogenweiche.abzweigenderStrang, original.geometrie, geometrie, krdiffs, log);
 
-  const auto& zuordnung = BerechneElementZuordnung(verbogen, unverbogen);
-  double lauflaenge = 0;
-  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
-    const auto& el = verbogen[i];
-    const auto& elUnverbogen = unverbogen[zuordnung[i]];
-    const auto krdiff = GetKruemmung(el) - GetKruemmung(elUnverbogen);
-    std::cout << " - Lauflaenge " << lauflaenge << ": verbogen " << el.first->Nr << " -> unverbogen " << elUnverbogen.first->Nr << ", krdiff=" << krdiff << "/Biegeradius=" << Radius(krdiff) << "\n";
-    result.emplace_back(lauflaenge, krdiff);
+    Tracespanne::ArgumentAktuell("Weiche", it.second);
+    found = true;
+    break;
+  }
 
-    lauflaenge += ElementLaenge(*el.first);
+  if (!found) {
+    if (log.fehler()) {
+      log << "Unverbogene Weiche kann nicht ermittelt werden\n";
+    }
+    result = 1;
   }
 
   return result;
 }
 
-std::vector<std::pair<double, double>> LiesBiegeparameter(const Zusi& datei, double offset) {
-  std::vector<std::pair<double, double>> result;
-  auto dateibeschreibung = datei.Info->Beschreibung;
-  std::replace(dateibeschreibung.begin(), dateibeschreibung.end(), ',', '.');
-
-  auto pos = dateibeschreibung.find('=');
-  double l = -offset;
-  double l_neu = l;
-  try {
-    while (pos != std::string::npos) {
-      if ((pos >= 1) && (std::string_view(&dateibeschreibung.at(pos-1), 1) == "l")) {
-        l_neu += std::stof(&dateibeschreibung.at(pos+1), nullptr);
-      } else if ((pos >= 2) && (std::string_view(&dateibeschreibung.at(pos-2), 2) == "kr")) {
-        const double kr = std::stof(&dateibeschreibung.at(pos+1), nullptr);
-        std::cout << " - Lauflaenge " << l << ": kr=" << kr << "/r=" << Radius(kr) << "\n";
-        l = l_neu;
-        if (l >= 0) {
-          result.emplace_back(l, kr);
-        }
-      }
-      pos = dateibeschreibung.find('=', pos + 1);
+// Liest die Streckendatei `dateiname` ein und verknuepft sie bei Bedarf neu.
+// Gibt bei Fehlern nullptr zurueck.
+std::unique_ptr<Streckendatei> OeffneStreckendatei(const std::string& dateiname,
+    const Optionen& optionen,
+    Arbeitspool& pool,
+    Protokoll& log) {
+  std::unique_ptr<Streckendatei> streckendatei;
+  {
+    Phasenmessung messung(Phase::StreckendateiLesen);
+    streckendatei = LiesStreckendatei(dateiname, optionen.leseoptionen, pool, log);
+  }
+  if (!streckendatei || !streckendatei->zusi->Strecke) {
+    if (log.fehler()) {
+      log << "Fehler beim Einlesen der Streckendatei\n";
     }
-  } catch (const std::invalid_argument&) {
-    std::cout << "Fehler beim Lesen der Dateibeschreibung\n";
-    return std::vector<std::pair<double, double>>();
+    return nullptr;
   }
+  Profil::Zaehle(Zaehler::Streckendateien);
 
-  return result;
+  if (optionen.verknuepfungsToleranz.has_value()) {
+    Phasenmessung messung(Phase::Verknuepfen);
+    const size_t anzahlGeaendert = VerknuepfeNeu(*streckendatei->zusi->Strecke, *optionen.verknuepfungsToleranz, pool);
+    if (log.normal()) {
+      log << "Streckennetz neu verknuepft, Verknuepfungen von " << anzahlGeaendert << " Elementen geaendert\n";
+    }
+  }
+  return streckendatei;
 }
 
-std::unordered_map<std::size_t, double> KorrigiereKruemmungAbzweigenderStrang(
-    const ElementUndRichtung& startElementUnverbogen,
-    const ElementUndRichtung& startElementVerbogen,
-    const std::vector<ElementUndRichtung>& unverbogen,
-    const std::vector<ElementUndRichtung>& verbogen,
-    const std::vector<std::pair<double, double>>& biegeparameter) {
-  std::unordered_map<std::size_t, double> result;
+// Korrigiert die Kruemmungen aller Bogenweichen in der Streckendatei `dateiname`
+// (bzw. nur der Bogenweiche mit Startelement `optionen.nurStartelement`, falls angegeben)
+// und schreibt das Ergebnis nach `dateiname`.new.st3.
+// Gibt 0 zurueck, wenn alle Bogenweichen erfolgreich bearbeitet wurden, sonst 1.
+int BearbeiteStreckendatei(const std::string& dateiname,
+    const Weichenzuordnung& OriginalWeichen,
+    Zwischenspeicher& zwischenspeicher,
+    const Optionen& optionen,
+    Arbeitspool& pool,
+    Protokoll& log) {
+  const auto& streckendatei = OeffneStreckendatei(dateiname, optionen, pool, log);
+  if (!streckendatei) {
+    return 1;
+  }
 
-  const auto& zuordnung = BerechneElementZuordnung(verbogen, unverbogen);
-  auto itBiegeparameter = biegeparameter.begin();
-  assert(itBiegeparameter != biegeparameter.end());
-  double lauflaenge = 0;
-  double winkelVorherEndeNeu;  // wird im ersten Schleifendurchlauf initialisiert
-  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
-    const auto& el = verbogen[i];
-    const auto& elUnverbogen = unverbogen[zuordnung[i]];
+  const auto& zusi = streckendatei->zusi;
 
-    if ((i < len - 1 && zuordnung[i] == zuordnung[i+1]) && (i == 0 || zuordnung[i] != zuordnung[i-1])) {
-      std::cout << "  ! Element " << elUnverbogen.first->Nr << " wurde vom Gleisplaneditor vor dem Biegen zerteilt, vermutlich keine sinnvolle Berechnung moeglich\n";
+  int result = 0;
+  std::vector<Weiche> bogenweichen;  // non-const wg. std::swap(geraderStrang, abzweigenderStrang)
+  {
+    Phasenmessung messung(Phase::FindeWeichen);
+    bogenweichen = FindeWeichen(*zusi->Strecke, Streckengraph(*zusi->Strecke), log, true);
+  }
+  Profil::Zaehle(Zaehler::Bogenweichen, bogenweichen.size());
+  const Geometrietabelle geometrie = [&zusi, &pool]() {
+    Phasenmessung messung(Phase::Geometrietabelle);
+    return Geometrietabelle(*zusi->Strecke, pool);
+  }();
+
+  // Die Bogenweichen werden parallel bearbeitet, jede mit eigener Ausgabe. Ausgaben und neue Kruemmungen
+  // werden anschliessend in der Reihenfolge der Startelemente zusammengefuehrt, sodass das Ergebnis
+  // nicht von der Anzahl der Threads abhaengt.
+  struct Bogenweichenergebnis {
+    int result = 0;
+    std::vector<std::pair<std::size_t, double>> kruemmungenNeu;
+    std::string log;
+  };
+  std::vector<Bogenweichenergebnis> ergebnisse(bogenweichen.size());
+  pool.ParallelFuer(bogenweichen.size(), [&](size_t idx) {
+    auto& bogenweiche = bogenweichen[idx];
+    auto& ergebnis = ergebnisse[idx];
+    Tracespanne spanne("bogenweiche", "Bogenweiche", bogenweiche.startElement.first->Nr);
+    std::ostringstream weichenausgabe;
+    Protokoll weichenlog(weichenausgabe, log.stufe());
+    if (weichenlog.normal()) {
+      weichenlog << "\nBogenweiche gefunden an Element " << bogenweiche.startElement.first->Nr << "\n";
     }
-
-    while (lauflaenge > itBiegeparameter->first + 2.5) {
-      ++itBiegeparameter;
-      assert(itBiegeparameter != biegeparameter.end());
+    if (!optionen.nurStartelement.has_value() || (bogenweiche.startElement.first->Nr == *optionen.nurStartelement)) {
+      ergebnis.result = BearbeiteBogenweiche(bogenweiche, geometrie, OriginalWeichen, zwischenspeicher, ergebnis.kruemmungenNeu, weichenlog);
     }
-
-    auto krNeu = GetKruemmung(elUnverbogen) + itBiegeparameter->second;
-    if (!el.second) {
-      krNeu = -krNeu;
+    ergebnis.log = weichenausgabe.str();
+    if (!weichenlog.normal() && !ergebnis.log.empty()) {
+      // Fehlermeldungen auch ohne Fortschrittsausgabe der Bogenweiche zuordnen
+      ergebnis.log.insert(0, "\nBogenweiche an Element " + std::to_string(bogenweiche.startElement.first->Nr) + ":\n");
     }
+  });
 
-    const auto& elVorherVerbogen = (i == 0 ? startElementVerbogen : verbogen[i-1]);
-    const auto& elVorherUnverbogen = (i == 0 ? startElementUnverbogen : unverbogen[zuordnung[i-1]]);
-
-    const auto winkelEl1EndeAlt = GetWinkel(elVorherVerbogen, ElementEnde::Ende);
-    if (i == 0) {
-      winkelVorherEndeNeu = winkelEl1EndeAlt;
+  Kruemmungstabelle kruemmungenNeu(zusi->Strecke->children_StrElement.size());
+  for (const auto& ergebnis : ergebnisse) {
+    log << ergebnis.log;
+    if (ergebnis.result != 0) {
+      result = 1;
     }
-    const auto winkelEl2AnfangAlt = GetWinkel(el, ElementEnde::Anfang);
-    const auto winkelEl2AnfangNeu = GetWinkel(el, ElementEnde::Anfang, krNeu);
-    const auto winkelEl1UnverbogenEnde = GetWinkel(elVorherUnverbogen, ElementEnde::Ende);
-    const auto winkelEl2UnverbogenAnfang = GetWinkel(elUnverbogen, ElementEnde::Anfang);
-
-    const auto knickAlt = WinkelDiff(winkelEl1EndeAlt, winkelEl2AnfangAlt);
-    const auto knickNeu = WinkelDiff(winkelVorherEndeNeu, winkelEl2AnfangNeu);
-    const auto knickUnverbogen = WinkelDiff(winkelEl1UnverbogenEnde, winkelEl2UnverbogenAnfang);
-
-    std::cout << "  > Knick " << HundertstelGrad(knickNeu)
-      << " (vs. vorher " << HundertstelGrad(knickAlt) << ": " << std::showpos << (knickAlt == 0.0 ? 0 : ((knickNeu-knickAlt)/knickAlt * 100)) << std::noshowpos << "%, "
-      << "vs. unverbogen " << HundertstelGrad(knickUnverbogen) << ": " << std::showpos << (knickUnverbogen == 0.0 ? 0 : ((knickNeu-knickUnverbogen)/knickUnverbogen * 100)) << std::noshowpos << "%)\n";
-
-    std::cout << " - Lauflaenge " << lauflaenge << ": verbogen " << el.first->Nr << " -> unverbogen " << elUnverbogen.first->Nr << ", krdiff = " << itBiegeparameter->second << " -> setze kr=" << krNeu << "/r=" << Radius(krNeu) << "\n";
-    result.emplace(el.first->Nr, krNeu);
-
-    winkelVorherEndeNeu = GetWinkel(el, ElementEnde::Ende, krNeu);
+    for (const auto& [nr, kr] : ergebnis.kruemmungenNeu) {
+      if (!kruemmungenNeu.Setze(nr, kr)) {
+        if (log.fehler()) {
+          log << "!! Element " << nr << " gehoert zu mehreren Bogenweichen mit unterschiedlicher neuer Kruemmung ("
+            << kruemmungenNeu.wert(nr) << " und " << kr << "), behalte " << kruemmungenNeu.wert(nr) << "\n";
+        }
+        result = 1;
+      }
+    }
+  }
 
-    lauflaenge += ElementLaenge(*el.first);
+  Phasenmessung messung(Phase::Schreiben);
+  if (!SchreibeNeueKruemmungen(*streckendatei, dateiname + ".new.st3", kruemmungenNeu, log)) {
+    result = 1;
   }
 
   return result;
 }
 
-void SchreibeNeueKruemmungen(const char* dateiname, const std::unordered_map<size_t, double> kruemmungenNeu) {
-  zusixml::FileReader reader(dateiname);
-  rapidxml::xml_document<> doc;
-  doc.parse<rapidxml::parse_non_destructive>(const_cast<char*>(reader.data()));
+// Prueft alle Stoesse der Streckendatei `dateiname` und gibt die mit einem Knick ueber
+// `optionen.knickSchwelle` aus, den groessten zuerst.
+// Gibt 0 zurueck, wenn kein solcher Stoss gefunden wurde, sonst 1.
+int PruefeKnicke(const std::string& dateiname,
+    const Optionen& optionen,
+    Arbeitspool& pool,
+    Protokoll& log) {
+  const auto& streckendatei = OeffneStreckendatei(dateiname, optionen, pool, log);
+  if (!streckendatei) {
+    return 1;
+  }
 
-  auto* const zusi_node = doc.first_node("Zusi");
-  auto* const strecke_node = zusi_node->first_node("Strecke");
+  const auto& strecke = *streckendatei->zusi->Strecke;
+  const Geometrietabelle geometrie = [&strecke, &pool]() {
+    Phasenmessung messung(Phase::Geometrietabelle);
+    return Geometrietabelle(strecke, pool);
+  }();
+  const double schwelleGrad = *optionen.knickSchwelle;
+  size_t anzahlStoesse = 0;
+  std::vector<Stoss> knicke;
+  {
+    Phasenmessung messung(Phase::Knickpruefung);
+    knicke = FindeKnicke(Streckengraph(strecke), geometrie, schwelleGrad * M_PI / 180.0, pool, anzahlStoesse);
+  }
+  Profil::Zaehle(Zaehler::Stoesse, anzahlStoesse);
 
-  for (auto* str_element_node = strecke_node->first_node("StrElement"); str_element_node; str_element_node = str_element_node->next_sibling("StrElement")) {
-    const auto* const nr_attrib = str_element_node->first_attribute("Nr");
-    if (!nr_attrib) {
-      continue;
+  if (log.normal()) {
+    log << anzahlStoesse << " Stoesse geprueft, " << knicke.size() << " mit Knick ueber " << schwelleGrad << " Grad\n";
+  }
+  if (log.fehler()) {
+    for (const auto& stoss : knicke) {
+      log << " - Element " << Nummer(stoss.element) << (Normrichtung(stoss.element) ? " (Norm)" : " (Gegen)")
+        << " -> " << Nummer(stoss.nachfolger) << (Normrichtung(stoss.nachfolger) ? " (Norm)" : " (Gegen)")
+        << ": Knick " << (stoss.knick * 180.0 / M_PI) << " Grad\n";
     }
+  }
 
-    const std::string s { nr_attrib->value(), nr_attrib->value_size() };
-    int nr = atoi(s.c_str());
+  return knicke.empty() ? 0 : 1;
+}
 
-    const auto& it = kruemmungenNeu.find(nr);
-    if (it == kruemmungenNeu.end()) {
+// Liest eine Liste von Streckendateien (eine pro Zeile, Zeilen mit '#' am Anfang werden ignoriert).
+bool LiesDateiliste(const std::string& dateiname, std::vector<std::string>& dateien) {
+  std::ifstream infile(dateiname);
+  if (!infile) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(infile, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
       continue;
     }
+    dateien.push_back(std::move(line));
+  }
+  return true;
+}
 
-    auto val_as_string = std::to_string(it->second);
-    auto* newval = doc.allocate_string(val_as_string.c_str());
+void PrintUsage(const char* programm) {
+  std::cout << "Aufruf: " << programm << " [Optionen] <datei.st3> [<datei.st3> ...]\n"
+    << "       " << programm << " <datei.st3> <Nr>\n"
+    << "Optionen:\n"
+    << "  -j <n>        Anzahl Threads (Standard: Anzahl Prozessorkerne)\n"
+    << "  -l <datei>    Streckendateien zusaetzlich aus Datei lesen (eine pro Zeile)\n"
+    << "  -e <Nr>       Nur die Bogenweiche mit Startelement <Nr> bearbeiten\n"
+    << "  --kein-mmap   Streckendateien in den Speicher lesen statt per mmap einzublenden\n"
+    << "  -q            Nur Fehler und Zusammenfassung ausgeben\n"
+    << "  -v            Ausfuehrliche Ausgabe (Elementlisten, Knickwinkel, Biegeparameter)\n"
+    << "  --zusammenfassung  Nur die Zusammenfassung ausgeben\n"
+    << "  --profile     Am Ende Wand- und CPU-Zeit der Programmphasen, Zaehler und maximalen Speicherbedarf ausgeben\n"
+    << "  --trace <datei>  Zeitleiste der Dateien, Bogenweichen und Programmphasen pro Thread im Chrome-Trace-Format\n"
+    << "                schreiben (anzeigbar mit Perfetto oder chrome://tracing)\n"
+    << "  --verknuepfen[=<m>]  Streckennetz vor der Bearbeitung anhand der Elementenden neu verknuepfen; Enden mit\n"
+    << "                hoechstens <m> Metern Abstand (Standard: 0.01) gelten als verbunden. Wirkt nur auf die Berechnung:\n"
+    << "                die neuen Nachfolger (NachNorm/NachGegen) werden nicht in die .new.st3 geschrieben\n"
+    << "  -k <Grad>     Knickpruefung: statt Bogenweichen zu korrigieren alle Stoesse mit einem Knick\n"
+    << "                ueber <Grad> ausgeben, den groessten zuerst (Datei gilt dann als fehlerhaft)\n";
+}
 
-    rapidxml::xml_attribute<>* kr_attrib = str_element_node->first_attribute("kr");
-    if (kr_attrib) {
-      kr_attrib->value(newval);
+int main(int argc, char* argv[]) {
+  std::vector<std::string> dateien;
+  Optionen optionen;
+  std::string traceDatei;
+  unsigned int anzahlThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg(argv[i]);
+    if ((arg == "-j" || arg == "-l" || arg == "-e" || arg == "-k" || arg == "--trace") && i + 1 >= argc) {
+      std::cout << "Fehlender Wert fuer Option " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    if (arg == "-j") {
+      anzahlThreads = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+    } else if (arg == "-l") {
+      if (!LiesDateiliste(argv[++i], dateien)) {
+        std::cout << "Fehler beim Laden der Dateiliste " << argv[i] << "\n";
+        return 1;
+      }
+    } else if (arg == "-e") {
+      optionen.nurStartelement = atoi(argv[++i]);
+    } else if (arg == "-k") {
+      optionen.knickSchwelle = atof(argv[++i]);
+    } else if (arg == "--verknuepfen") {
+      optionen.verknuepfungsToleranz = 0.01;
+    } else if (arg.rfind("--verknuepfen=", 0) == 0) {
+      const auto wert = arg.substr(std::strlen("--verknuepfen="));
+      double toleranz = 0;
+      const auto [ende, fehler] = std::from_chars(wert.data(), wert.data() + wert.size(), toleranz);
+      if (fehler != std::errc() || ende != wert.data() + wert.size() || !(toleranz > 0) || !std::isfinite(toleranz)) {
+        std::cout << "Ungueltige Toleranz fuer --verknuepfen: " << wert << " (erwartet wird eine Zahl > 0 in Metern)\n";
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      optionen.verknuepfungsToleranz = toleranz;
+    } else if (arg == "--kein-mmap") {
+      optionen.leseoptionen.mmap = false;
+    } else if (arg == "-q") {
+      optionen.ausgabestufe = Ausgabestufe::Fehler;
+    } else if (arg == "-v") {
+      optionen.ausgabestufe = Ausgabestufe::Ausfuehrlich;
+    } else if (arg == "--zusammenfassung") {
+      optionen.ausgabestufe = Ausgabestufe::Zusammenfassung;
+    } else if (arg == "--profile") {
+      Profil::Aktiviere();
+    } else if (arg == "--trace") {
+      traceDatei = argv[++i];
+      Profil::AktiviereTrace();
+    } else if (arg == "-h" || arg == "--help") {
+      PrintUsage(argv[0]);
+      return 0;
     } else {
-      str_element_node->append_attribute(doc.allocate_attribute("kr", newval));
+      dateien.emplace_back(arg);
     }
   }
 
-  std::string out_string;
-  rapidxml::print(std::back_inserter(out_string), doc, rapidxml::print_no_indenting);
-
-  std::string dateiname_neu = std::string(dateiname) + ".new.st3";
-  std::ofstream o(dateiname_neu, std::ios::binary);
-  o << out_string;
-  std::cout << "Neue ST3-Datei geschrieben: " << dateiname_neu << "\n";
-}
-
-int main(int argc, char* argv[]) {
-  (void)argc;
-  const std::vector<std::pair<std::string, std::string>> OriginalWeichen = GetWeichenMapping();
+  // Kompatibilitaet zum frueheren Aufruf "radius_bogenweichen <datei.st3> <Nr>"
+  if (argc == 3 && dateien.size() == 2 && !dateien[1].empty()
+      && dateien[1].find_first_not_of("0123456789") == std::string::npos) {
+    optionen.nurStartelement = atoi(dateien[1].c_str());
+    dateien.pop_back();
+  }
 
-  const auto& zusi = zusixml::parseFile(argv[1]);
-  if (!zusi || !zusi->Strecke) {
-    std::cout << "Fehler beim Einlesen der Streckendatei\n";
+  if (dateien.empty()) {
+    PrintUsage(argv[0]);
     return 1;
   }
 
-  const auto& printElemente = [](const ElementUndRichtung& startElement, const std::vector<ElementUndRichtung>& elemente) {
-    for (size_t i = 0, len = elemente.size() + 1; i < len; ++i) {
-      const auto& el = (i == 0 ? startElement : elemente[i - 1]);
-      const auto kr = GetKruemmung(el);
-      std::cout << " - " << el.first->Nr << ",l=" << ElementLaenge(*el.first) << ", kr=" << kr << "/r=" << Radius(kr);
-      if (i == 0) {
-        std::cout << " (Verzweigungselement)";
-      }
-      std::cout << "\n";
-      if (i < len - 1) {
-        const auto& el2 = elemente[i];
-        const auto winkelEl1Ende = GetWinkel(el, ElementEnde::Ende);
-        const auto winkelEl2Anfang = GetWinkel(el2, ElementEnde::Anfang);
-        // std::cout << ", w1=" << winkelEl1Ende << ", w2=" << winkelEl2Anfang;
-        const auto knick = WinkelDiff(winkelEl1Ende, winkelEl2Anfang);
-        std::cout << "  > Knick " << HundertstelGrad(knick) << "\n";
-      }
+  Protokoll log(std::cout, optionen.ausgabestufe);
+  const Weichenzuordnung OriginalWeichen = [&optionen, &log]() {
+    Phasenmessung messung(Phase::Weichenzuordnung);
+    return optionen.knickSchwelle.has_value() ? Weichenzuordnung {} : GetWeichenMapping(log);
+  }();
+  Zwischenspeicher zwischenspeicher;
+
+  const auto& printCacheStatistik = [&zwischenspeicher, &optionen, &log]() {
+    if (!log.normal() || optionen.knickSchwelle.has_value()) {
+      return;
     }
+    log << "Cache unverbogene Weichen: " << zwischenspeicher.originalweichen.Treffer() << " Treffer, "
+      << zwischenspeicher.originalweichen.Fehlschlaege() << " Fehlschlaege\n";
+    log << "Cache LS3-Biegeparameter: " << zwischenspeicher.biegeparameter.Treffer() << " Treffer, "
+      << zwischenspeicher.biegeparameter.Fehlschlaege() << " Fehlschlaege\n";
   };
 
-  int result = 0;
-  std::unordered_map<std::size_t, double> kruemmungenNeu;
-  for (auto& bogenweiche : FindeWeichen(*zusi->Strecke, true)) {  // non-const wg. std::swap(geraderStrang, abzweigenderStrang)
-    std::cout << "\nBogenweiche gefunden an Element " << bogenweiche.startElement.first->Nr << "\n";
-    if ((argc >= 3) and (bogenweiche.startElement.first->Nr != atoi(argv[2]))) {
-      continue;
-    }
-    if (bogenweiche.geraderStrang.empty() || bogenweiche.abzweigenderStrang.empty()) {
-      std::cout << "Im geraden oder abzweigenden Strang sind keine Elemente vorhanden. Wurde vergessen, nach dem ST3-Export das Streckennetz neu zu verknuepfen?\n";
-      result = 1;
-      continue;
+  const auto& printProfil = [&zwischenspeicher, &traceDatei]() {
+    if (Profil::traceAktiv() && !Profil::SchreibeTrace(traceDatei)) {
+      std::cout << "Fehler beim Schreiben der Trace-Datei " << traceDatei << "\n";
     }
-    std::cout << "Erster Signalframe an Position (0,0,0):\n";
-    const auto& signalframes = bogenweiche.weichensignal->children_SignalFrame;
-    const auto& itErsterSignalframe = std::find_if(signalframes.begin(), signalframes.end(),
-        [](const auto& signalframe) {
-          return std::abs(signalframe->p.X) < 0.0001
-            && std::abs(signalframe->p.Y) < 0.0001
-            && std::abs(signalframe->p.Z) < 0.0001;
-        });
-
-    if (itErsterSignalframe == signalframes.end()) {
-      std::cout << "Kein Signalframe an Position (0, 0, 0), unverbogene Weiche kann nicht ermittelt werden\n";
-      result = 1;
-      continue;
+    if (!Profil::aktiv()) {
+      return;
     }
+    Profil::Zaehle(Zaehler::OriginalweichenTreffer, zwischenspeicher.originalweichen.Treffer());
+    Profil::Zaehle(Zaehler::OriginalweichenFehlschlaege, zwischenspeicher.originalweichen.Fehlschlaege());
+    Profil::Zaehle(Zaehler::BiegeparameterTreffer, zwischenspeicher.biegeparameter.Treffer());
+    Profil::Zaehle(Zaehler::BiegeparameterFehlschlaege, zwischenspeicher.biegeparameter.Fehlschlaege());
+    Profil::Ausgeben(std::cout);
+  };
 
-    const auto& dateinameErsterSignalframe = (*itErsterSignalframe)->Datei.Dateiname;
-    std::cout << " - " << dateinameErsterSignalframe << "\n";
-
-    std::cout << "Elemente in Strang 1:\n";
-    printElemente(bogenweiche.startElement, bogenweiche.geraderStrang);
-    std::cout << "Elemente in Strang 2:\n";
-    printElemente(bogenweiche.startElement, bogenweiche.abzweigenderStrang);
-
-    // Originaldatei herausfinden
-    bool found = false;
-    for (const auto& it : OriginalWeichen) {
-      if (dateinameErsterSignalframe.find(it.first) != std::string::npos) {
-        std::cout << "Unverbogene Weiche: " << it.second << "\n";
-        const auto& st3Original = zusixml::parseFile(zusixml::ZusiPfad::vonZusiPfad(it.second).alsOsPfad());
-        if (!st3Original || !st3Original->Strecke) {
-          result = 1;
-          std::cout << "Fehler beim Parsen\n";
-          continue;
-        }
-
-        const auto& originaldateiWeichen = FindeWeichen(*st3Original->Strecke);
-        if (originaldateiWeichen.size() != 1) {
-          std::cout << "Nicht genau eine Weiche in der ST3-Datei gefunden\n";
-          result = 1;
-          continue;
-        }
-        const auto& originalweiche = originaldateiWeichen[0];
-        // Annahme: Erster Nachfolger der Originalweiche ist gerader Strang
-        std::cout << "Elemente im geraden Strang:\n";
-        printElemente(originalweiche.startElement, originalweiche.geraderStrang);
-        std::cout << "Elemente im abzweigenden Strang:\n";
-        printElemente(originalweiche.startElement, originalweiche.abzweigenderStrang);
-
-        if (!std::all_of(originalweiche.geraderStrang.begin(), originalweiche.geraderStrang.end(), [](const auto& elementRichtung) {
-              return std::abs(elementRichtung.first->kr) < 0.00001f;
-            })) {
-          std::cout << "Gerader Strang der unverbogenen Weiche hat nicht ueberall Kruemmung 0\n";
-          result = 1;
-          continue;
-        }
-
-        // Herausfinden, welches der abzweigende Strang in der verbogenen Weiche ist
-        // (die Vorzugslage koennte geaendert worden sein)
-        // -> Vergleiche die Vorzeichen der Winkel (Ende gerader Strang) - (Startelement) - (Ende abzweigender Strang)
-        // fuer Original und Bogenweiche (beim Biegen wird die relative Lage der Streckenelemente zueinander nicht veraendert).
-        const auto& bogenweicheScheitel = GetElementEnde(bogenweiche.startElement, ElementEnde::Anfang);
-        const auto& bogenweicheP1 = GetElementEnde(bogenweiche.geraderStrang.back(), ElementEnde::Ende);
-        const auto& bogenweicheP2 = GetElementEnde(bogenweiche.abzweigenderStrang.back(), ElementEnde::Ende);
-
-        const auto& originalweicheScheitel = GetElementEnde(originalweiche.startElement, ElementEnde::Anfang);
-        const auto& originalweicheP1 = GetElementEnde(originalweiche.geraderStrang.back(), ElementEnde::Ende);
-        const auto& originalweicheP2 = GetElementEnde(originalweiche.abzweigenderStrang.back(), ElementEnde::Ende);
-
-        const auto winkelBogenweicheP1 = atan2(bogenweicheP1.Y - bogenweicheScheitel.Y, bogenweicheP1.X - bogenweicheScheitel.X);
-        const auto winkelBogenweicheP2 = atan2(bogenweicheP2.Y - bogenweicheScheitel.Y, bogenweicheP2.X - bogenweicheScheitel.X);
-        const auto winkelDiffBogenweiche = LinksVon(winkelBogenweicheP2, winkelBogenweicheP1);
-
-        const auto winkelOriginalweicheP1 = atan2(originalweicheP1.Y - originalweicheScheitel.Y, originalweicheP1.X - originalweicheScheitel.X);
-        const auto winkelOriginalweicheP2 = atan2(originalweicheP2.Y - originalweicheScheitel.Y, originalweicheP2.X - originalweicheScheitel.X);
-        const auto winkelDiffOriginalweiche = LinksVon(winkelOriginalweicheP2, winkelOriginalweicheP1);
-
-        if (winkelDiffBogenweiche != winkelDiffOriginalweiche) {
-          std::swap(bogenweiche.geraderStrang, bogenweiche.abzweigenderStrang);
-          std::cout << "Strang 2 in Bogenweiche ist gerader Strang, Strang 1 ist abzweigender Strang\n";
-        } else {
-          std::cout << "Strang 1 in Bogenweiche ist gerader Strang, Strang 2 ist abzweigender Strang\n";
-        }
-
-        std::vector<std::pair<double, double>> krdiffs;
-        std::cout << "Lies Bogenweichen-Parameter aus verbogener LS3-Datei " << dateinameErsterSignalframe << "\n";
-        const auto& ls3Verbogen = zusixml::parseFile(zusixml::ZusiPfad::vonZusiPfad(dateinameErsterSignalframe).alsOsPfad());
-        if (ls3Verbogen) {
-          krdiffs = LiesBiegeparameter(*ls3Verbogen, ElementLaenge(*originalweiche.startElement.first));  // Laenge des Verzweigungselements soll nicht in Lauflaenge enthalten sein
-        } else {
-          std::cout << "Fehler beim Einlesen\n";
-        }
+  Arbeitspool pool(anzahlThreads);
 
-        if (krdiffs.empty()) {
-          std::cout << "Berechne Bogenweichen-Parameter aus den Kruemmungsunterschieden des geraden Strangs\n";
-          krdiffs = BerechneBiegeparameter(originalweiche.geraderStrang, bogenweiche.geraderStrang);
-        }
+  const auto& bearbeite = [&](const std::string& dateiname, Protokoll& dateilog) {
+    Tracespanne spanne("datei", dateiname);
+    return optionen.knickSchwelle.has_value()
+      ? PruefeKnicke(dateiname, optionen, pool, dateilog)
+      : BearbeiteStreckendatei(dateiname, OriginalWeichen, zwischenspeicher, optionen, pool, dateilog);
+  };
 
-        std::cout << "Wende Bogenweichen-Parameter auf abzweigenden Strang an\n";
-        kruemmungenNeu.merge(KorrigiereKruemmungAbzweigenderStrang(originalweiche.startElement, bogenweiche.startElement, originalweiche.abzweigenderStrang, bogenweiche.abzweigenderStrang, krdiffs));
+  // Eine einzelne Datei wird ohne Pufferung und Zusammenfassung bearbeitet,
+  // ausser es soll ausschliesslich die Zusammenfassung ausgegeben werden.
+  if (dateien.size() == 1 && log.fehler()) {
+    const int result = bearbeite(dateien[0], log);
+    printCacheStatistik();
+    printProfil();
+    return result;
+  }
 
-        found = true;
-        break;
+  // Stapelbetrieb: Die Streckendateien werden parallel bearbeitet (und innerhalb jeder Datei die Bogenweichen).
+  // Die Ausgabe jeder Datei wird gepuffert und in der Reihenfolge der Dateiliste ausgegeben,
+  // sobald alle vorherigen Dateien fertig sind.
+  struct Ergebnis {
+    std::string log;
+    int result = 0;
+    bool fertig = false;
+  };
+  std::vector<Ergebnis> ergebnisse(dateien.size());
+  std::mutex ausgabeMutex;
+  size_t naechsteAusgabe = 0;
+
+  // Die Streckenelemente fertig bearbeiteter Dateien werden fuer die folgenden Dateien wiederverwendet
+  // (hoechstens Elementspeicher::STANDARD_MAX_ANZAHL, der Rest wird sofort freigegeben)
+  Elementspeicher elementspeicher;
+  optionen.leseoptionen.speicher = &elementspeicher;
+
+  pool.ParallelFuer(dateien.size(), [&](size_t idx) {
+    std::ostringstream ausgabe;
+    Protokoll dateilog(ausgabe, optionen.ausgabestufe);
+    int result;
+    try {
+      result = bearbeite(dateien[idx], dateilog);
+    } catch (const std::exception& e) {
+      if (dateilog.fehler()) {
+        dateilog << "Fehler: " << e.what() << "\n";
       }
+      result = 1;
     }
 
-    if (!found) {
-      std::cout << "Unverbogene Weiche kann nicht ermittelt werden\n";
-      result = 1;
+    std::lock_guard<std::mutex> lock(ausgabeMutex);
+    ergebnisse[idx].log = ausgabe.str();
+    ergebnisse[idx].result = result;
+    ergebnisse[idx].fertig = true;
+    for (; naechsteAusgabe < dateien.size() && ergebnisse[naechsteAusgabe].fertig; ++naechsteAusgabe) {
+      // Ohne Fortschrittsausgabe nur Dateien mit Meldungen auffuehren
+      if (log.normal() || !ergebnisse[naechsteAusgabe].log.empty()) {
+        std::cout << "\n=== " << dateien[naechsteAusgabe] << " ===\n" << ergebnisse[naechsteAusgabe].log;
+      }
+      ergebnisse[naechsteAusgabe].log.clear();
+    }
+  });
+  optionen.leseoptionen.speicher = nullptr;
+  elementspeicher.Leeren();
+
+  size_t anzahlFehler = 0;
+  std::cout << "\nZusammenfassung:\n";
+  for (size_t idx = 0; idx < dateien.size(); ++idx) {
+    std::cout << (ergebnisse[idx].result == 0 ? " OK     " : " FEHLER ") << dateien[idx] << "\n";
+    if (ergebnisse[idx].result != 0) {
+      ++anzahlFehler;
     }
   }
+  std::cout << dateien.size() << " Streckendateien bearbeitet, " << (dateien.size() - anzahlFehler) << " erfolgreich, " << anzahlFehler << " mit Fehlern\n";
+  printCacheStatistik();
+  printProfil();
 
-  SchreibeNeueKruemmungen(argv[1], kruemmungenNeu);
-
-  return result;
+  return anzahlFehler == 0 ? 0 : 1;
 }
@@ -0,0 +1,283 @@
+#include "referenzberechnung.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace referenz {
+
+double ElementLaenge(const StrElement& el) {
+  return std::hypot(el.b.X - el.g.X, el.b.Y - el.g.Y, el.b.Z - el.g.Z);
+}
+
+double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende, double kr /* in Normrichtung */) {
+  const auto& p1 = GetElementEnde(elementRichtung, ElementEnde::Anfang);
+  const auto& p2 = GetElementEnde(elementRichtung, ElementEnde::Ende);
+  double result = atan2(p2.Y - p1.Y, p2.X - p1.X);  // Winkel ohne Kruemmung
+
+  if (std::abs(kr) >= 1/100000.0) {
+    if (!elementRichtung.second) {
+      kr = -kr;
+    }
+    const double radius = 1.0/kr;
+    const double tangentenwinkel = asin(referenz::ElementLaenge(*elementRichtung.first) / (2.0 * std::abs(radius)));
+
+    if ((kr > 0) == (ende == ElementEnde::Anfang)) {
+      result -= tangentenwinkel;
+    } else {
+      result += tangentenwinkel;
+    }
+  }
+
+  return result;
+}
+
+double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende) {
+  return GetWinkel(elementRichtung, ende, elementRichtung.first->kr);
+}
+
+std::vector<size_t> BerechneElementZuordnung(const std::vector<ElementUndRichtung>& vec, const std::vector<ElementUndRichtung>& referenz) {
+  std::vector<size_t> result;
+  result.reserve(vec.size());
+  auto itReferenz = referenz.begin();
+
+  constexpr double epsilon = 0.3;  // Erlaubte Laengenabweichung zwischen Original- und verbogenem Element
+
+  double ldiff = -referenz::ElementLaenge(*itReferenz->first);  // Lauflaenge vec - Lauflaenge referenz
+  for (size_t i = 0, len = vec.size(); i < len; ++i) {
+    const auto& el = vec[i];
+
+    assert(itReferenz != referenz.end());
+    result.push_back(itReferenz - referenz.begin());
+
+    ldiff += referenz::ElementLaenge(*el.first);
+    if (std::abs(ldiff) <= epsilon) {
+      ldiff = 0;
+    }
+
+    if (i < len - 1) {
+      while (ldiff > -epsilon) {
+        ++itReferenz;
+        assert(itReferenz != referenz.end());
+        ldiff -= referenz::ElementLaenge(*itReferenz->first);
+      }
+    }
+  }
+
+  return result;
+}
+
+std::vector<std::pair<double, double>> BerechneBiegeparameter(const std::vector<ElementUndRichtung>& unverbogen, const std::vector<ElementUndRichtung>& verbogen) {
+  std::vector<std::pair<double, double>> result;
+  result.reserve(verbogen.size());
+
+  const auto& zuordnung = BerechneElementZuordnung(verbogen, unverbogen);
+  double lauflaenge = 0;
+  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
+    const auto& el = verbogen[i];
+    const auto& elUnverbogen = unverbogen[zuordnung[i]];
+    result.emplace_back(lauflaenge, GetKruemmung(el) - GetKruemmung(elUnverbogen));
+    lauflaenge += referenz::ElementLaenge(*el.first);
+  }
+
+  return result;
+}
+
+std::vector<std::pair<double, double>> LiesBiegeparameter(const std::string& beschreibung, double offset) {
+  std::vector<std::pair<double, double>> result;
+  auto dateibeschreibung = beschreibung;
+  std::replace(dateibeschreibung.begin(), dateibeschreibung.end(), ',', '.');
+
+  auto pos = dateibeschreibung.find('=');
+  double l = -offset;
+  double l_neu = l;
+  try {
+    while (pos != std::string::npos) {
+      if ((pos >= 1) && (std::string_view(&dateibeschreibung.at(pos-1), 1) == "l")) {
+        l_neu += std::stof(&dateibeschreibung.at(pos+1), nullptr);
+      } else if ((pos >= 2) && (std::string_view(&dateibeschreibung.at(pos-2), 2) == "kr")) {
+        const double kr = std::stof(&dateibeschreibung.at(pos+1), nullptr);
+        l = l_neu;
+        if (l >= 0) {
+          result.emplace_back(l, kr);
+        }
+      }
+      pos = dateibeschreibung.find('=', pos + 1);
+    }
+  } catch (const std::invalid_argument&) {
+    return std::vector<std::pair<double, double>>();
+  }
+
+  return result;
+}
+
+std::vector<std::pair<std::size_t, double>> KorrigiereKruemmungAbzweigenderStrang(
+    const std::vector<ElementUndRichtung>& unverbogen,
+    const std::vector<ElementUndRichtung>& verbogen,
+    const std::vector<std::pair<double, double>>& biegeparameter) {
+  std::vector<std::pair<std::size_t, double>> result;
+
+  const auto& zuordnung = BerechneElementZuordnung(verbogen, unverbogen);
+  auto itBiegeparameter = biegeparameter.begin();
+  assert(itBiegeparameter != biegeparameter.end());
+  double lauflaenge = 0;
+  for (size_t i = 0, len = verbogen.size(); i < len; ++i) {
+    const auto& el = verbogen[i];
+    const auto& elUnverbogen = unverbogen[zuordnung[i]];
+
+    while (lauflaenge > itBiegeparameter->first + 2.5) {
+      ++itBiegeparameter;
+      assert(itBiegeparameter != biegeparameter.end());
+    }
+
+    auto krNeu = GetKruemmung(elUnverbogen) + itBiegeparameter->second;
+    if (!el.second) {
+      krNeu = -krNeu;
+    }
+    result.emplace_back(el.first->Nr, krNeu);
+
+    lauflaenge += referenz::ElementLaenge(*el.first);
+  }
+
+  return result;
+}
+
+namespace {
+
+// Nachfolger wie im Stand vor dem Streckengraphen
+ElementUndRichtung GetNachfolger(const Strecke& str, ElementUndRichtung el, size_t idx) {
+  const auto& nachfolgerArray = (el.second ? el.first->children_NachNorm : el.first->children_NachGegen);
+  const auto& anschlussMask = (el.second ? 0x1 : 0x100) << idx;
+
+  if (idx >= nachfolgerArray.size()) {
+    return { nullptr, false };
+  }
+  const auto& nachfolgerNr = nachfolgerArray[idx].Nr;
+  if (nachfolgerNr < 0 || static_cast<size_t>(nachfolgerNr) >= str.children_StrElement.size() || !str.children_StrElement[nachfolgerNr]) {
+    return { nullptr, false };
+  }
+  return { str.children_StrElement[nachfolgerNr].get(), (el.first->Anschluss & anschlussMask) == 0 };
+}
+
+const Vec3& GetEndpunkt(const StrElement& el, size_t punkt) {
+  return (punkt & 1) ? el.b : el.g;
+}
+
+double Abstandsquadrat(const Vec3& a, const Vec3& b) {
+  return (double(a.X) - b.X) * (double(a.X) - b.X) + (double(a.Y) - b.Y) * (double(a.Y) - b.Y) + (double(a.Z) - b.Z) * (double(a.Z) - b.Z);
+}
+
+// Gibt true zurueck, wenn man vom Element `el` ueber dessen Endpunkt `punkt` ohne Richtungsumkehr auf `nachfolger`
+// ueber dessen Endpunkt `punktNachfolger` uebergehen kann (Skalarprodukt der Sehnen).
+bool OhneRichtungsumkehr(const StrElement& el, size_t punkt, const StrElement& nachfolger, size_t punktNachfolger) {
+  const auto& aus1 = GetEndpunkt(el, punkt ^ 1);
+  const auto& aus2 = GetEndpunkt(el, punkt);
+  const auto& ein1 = GetEndpunkt(nachfolger, punktNachfolger);
+  const auto& ein2 = GetEndpunkt(nachfolger, punktNachfolger ^ 1);
+  return (double(aus2.X) - aus1.X) * (double(ein2.X) - ein1.X) + (double(aus2.Y) - aus1.Y) * (double(ein2.Y) - ein1.Y)
+    + (double(aus2.Z) - aus1.Z) * (double(ein2.Z) - ein1.Z) > 0;
+}
+
+}  // namespace
+
+std::vector<Stoss> FindeKnicke(const Strecke& strecke) {
+  std::vector<Stoss> result;
+  for (size_t nr = 0; nr < strecke.children_StrElement.size(); ++nr) {
+    const auto& el = strecke.children_StrElement[nr];
+    if (!el) {
+      continue;
+    }
+    for (const bool norm : { true, false }) {
+      const ElementUndRichtung er { el.get(), norm };
+      const size_t anzahl = norm ? el->children_NachNorm.size() : el->children_NachGegen.size();
+      for (size_t idx = 0; idx < anzahl; ++idx) {
+        const auto nachfolger = GetNachfolger(strecke, er, idx);
+        if (!nachfolger.first) {
+          continue;
+        }
+        const size_t nrNachfolger = static_cast<size_t>(nachfolger.first->Nr);
+        // Beidseitig verknuepfte Stoesse nur vom Element mit der kleineren Nummer aus
+        if (nrNachfolger < nr || (nrNachfolger == nr && !norm)) {
+          const ElementUndRichtung rueckwaerts { nachfolger.first, !nachfolger.second };
+          const size_t anzahlRueckwaerts = rueckwaerts.second ? nachfolger.first->children_NachNorm.size() : nachfolger.first->children_NachGegen.size();
+          bool rueckverweis = false;
+          for (size_t i = 0; i < anzahlRueckwaerts && !rueckverweis; ++i) {
+            const auto vorgaenger = GetNachfolger(strecke, rueckwaerts, i);
+            rueckverweis = vorgaenger.first && static_cast<size_t>(vorgaenger.first->Nr) == nr;
+          }
+          if (rueckverweis) {
+            continue;
+          }
+        }
+        const double knick = std::abs(std::remainder(GetWinkel(nachfolger, ElementEnde::Anfang) - GetWinkel(er, ElementEnde::Ende), 2 * M_PI));
+        result.push_back(Stoss { MitRichtung(nr, norm), MitRichtung(nrNachfolger, nachfolger.second), knick });
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<std::vector<std::pair<size_t, bool>>> Nachfolger(const Strecke& strecke, double toleranz) {
+  const size_t anzahlPunkte = 2 * strecke.children_StrElement.size();
+  std::vector<std::pair<float, size_t>> punkteNachX;
+  for (size_t punkt = 0; punkt < anzahlPunkte; ++punkt) {
+    if (const auto& el = strecke.children_StrElement[punkt / 2]) {
+      punkteNachX.emplace_back(GetEndpunkt(*el, punkt).X, punkt);
+    }
+  }
+  std::sort(punkteNachX.begin(), punkteNachX.end());
+
+  // Alle Endpunkte anderer Elemente hoechstens `toleranz` von Endpunkt `punkt` entfernt
+  const double toleranzQuadrat = toleranz * toleranz;
+  const auto nahePunkte = [&](size_t punkt) {
+    std::vector<size_t> result;
+    const auto& p = GetEndpunkt(*strecke.children_StrElement[punkt / 2], punkt);
+    auto it = std::lower_bound(punkteNachX.begin(), punkteNachX.end(), std::make_pair(static_cast<float>(p.X - toleranz), size_t { 0 }));
+    for (; it != punkteNachX.end() && it->first <= p.X + toleranz; ++it) {
+      if (it->second / 2 != punkt / 2
+          && Abstandsquadrat(GetEndpunkt(*strecke.children_StrElement[it->second / 2], it->second), p) <= toleranzQuadrat) {
+        result.push_back(it->second);
+      }
+    }
+    return result;
+  };
+
+  std::vector<std::vector<std::pair<size_t, bool>>> result(anzahlPunkte);
+  for (size_t punkt = 0; punkt < anzahlPunkte; ++punkt) {
+    const auto& el = strecke.children_StrElement[punkt / 2];
+    if (!el) {
+      continue;
+    }
+    std::vector<size_t> gefunden;
+    for (const size_t q : nahePunkte(punkt)) {
+      const auto& nachfolger = *strecke.children_StrElement[q / 2];
+      if (!OhneRichtungsumkehr(*el, punkt, nachfolger, q)) {
+        continue;
+      }
+      // Ein echt naeher liegendes, ebenfalls passendes Element am Anfang des Nachfolgers geht vor
+      const double abstand = Abstandsquadrat(GetEndpunkt(*el, punkt), GetEndpunkt(nachfolger, q));
+      bool naechster = true;
+      for (const size_t r : nahePunkte(q)) {
+        const auto& anderes = *strecke.children_StrElement[r / 2];
+        if (r / 2 != punkt / 2 && Abstandsquadrat(GetEndpunkt(anderes, r), GetEndpunkt(nachfolger, q)) < abstand
+            && OhneRichtungsumkehr(anderes, r, nachfolger, q)) {
+          naechster = false;
+        }
+      }
+      if (naechster) {
+        gefunden.push_back(q);
+      }
+    }
+    // Ein Element hoechstens einmal, bevorzugt mit seinem Anfang
+    std::sort(gefunden.begin(), gefunden.end());
+    gefunden.erase(std::unique(gefunden.begin(), gefunden.end(), [](size_t a, size_t b) { return a / 2 == b / 2; }), gefunden.end());
+    for (const size_t q : gefunden) {
+      result[punkt].emplace_back(q / 2, (q & 1) != 0);
+    }
+  }
+  return result;
+}
+
+}  // namespace referenz
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include "bogenweichen.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Skalare Referenzimplementierung der Bogenweichenberechnung im Stand vor Geometrietabelle und Geometriekernen:
+// Laengen und Winkel werden bei jeder Verwendung unveraendert wie dort mit std::hypot, atan2 und asin direkt aus
+// den Streckenelementen berechnet (hypot mit float-Argumenten, also nur auf float-Genauigkeit). Wird nicht optimiert, sondern dient bogenweichen_bench --vergleiche als Massstab
+// fuer die Funktionen aus bogenweichen.hpp, fuer SchreibeNeueKruemmungen, FindeKnicke und VerknuepfeNeu.
+namespace referenz {
+
+double ElementLaenge(const StrElement& el);
+
+// Winkel der Kreistangente am Anfang bzw. Ende des Elements, wenn es die Kruemmung `kr` haette.
+double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende, double kr /* in Normrichtung */);
+
+// Wie oben mit der im Element gespeicherten Kruemmung
+double GetWinkel(const ElementUndRichtung& elementRichtung, ElementEnde ende);
+
+std::vector<size_t> BerechneElementZuordnung(const std::vector<ElementUndRichtung>& vec, const std::vector<ElementUndRichtung>& referenz);
+
+std::vector<std::pair<double, double>> BerechneBiegeparameter(const std::vector<ElementUndRichtung>& unverbogen, const std::vector<ElementUndRichtung>& verbogen);
+
+// Wie ::LiesBiegeparameter, aber direkt auf der Dateibeschreibung. Gibt bei Lesefehlern eine leere Liste zurueck.
+std::vector<std::pair<double, double>> LiesBiegeparameter(const std::string& beschreibung, double offset);
+
+// Neue Kruemmungen der Elemente des abzweigenden Strangs als Paare (Nr, kr), in der Reihenfolge des Strangs
+std::vector<std::pair<std::size_t, double>> KorrigiereKruemmungAbzweigenderStrang(
+    const std::vector<ElementUndRichtung>& unverbogen,
+    const std::vector<ElementUndRichtung>& verbogen,
+    const std::vector<std::pair<double, double>>& biegeparameter);
+
+// Stoss mit Knick wie ::Stoss aus knickpruefung.hpp
+struct Stoss {
+  ElementRichtung element;
+  ElementRichtung nachfolger;
+  double knick;
+};
+
+// Alle Stoesse der Strecke wie FindeKnicke mit negativer Schwelle, aber ueber die Nachfolgerlisten und das
+// Anschluss-Attribut der Streckenelemente statt ueber den Streckengraphen. Nach Element sortiert.
+std::vector<Stoss> FindeKnicke(const Strecke& strecke);
+
+// Nachfolger, die VerknuepfeNeu an den Elementenden setzt, als Paare (Nr, am Ende b angeschlossen), nach Nummer sortiert.
+// Index 2 * nr + 1: Ende b (children_NachNorm), 2 * nr: Anfang g (children_NachGegen). Sucht die nahen Endpunkte
+// in der nach X sortierten Liste aller Endpunkte statt im Raster.
+std::vector<std::vector<std::pair<size_t, bool>>> Nachfolger(const Strecke& strecke, double toleranz);
+
+}  // namespace referenz
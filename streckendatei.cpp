@@ -0,0 +1,648 @@
+#include "streckendatei.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "profil.hpp"
+#include "xmlleser.hpp"
+
+namespace {
+
+// Kleinere Abschnitte lohnen das parallele Lesen nicht
+constexpr size_t MIN_ABSCHNITTSGROESSE = 1 << 20;
+
+// Attributwert, der keine gueltige Zahl ist, fuer die Warnung nach dem Einlesen. Zeigt in den Dateiinhalt.
+struct UngueltigeZahl {
+  std::string_view tag;
+  std::string_view attribut;
+  std::string_view wert;
+};
+
+// Attributwerte sind nicht nullterminiert, deshalb from_chars auf genau dem Wert (unabhaengig von der C-Locale).
+// Fuehrende Leerzeichen und ein '+' werden wie von strtod uebersprungen. Ein leerer Wert laesst `ziel` unveraendert.
+// Ein Wert, der nicht vollstaendig eine Zahl ist oder ausserhalb des Wertebereichs liegt, wird wie vom Zusi-Parser
+// nachsichtig als 0 gelesen; dann wird false zurueckgegeben, damit der Aufrufer warnen kann.
+template<typename T>
+bool LiesZahl(std::string_view wert, T& ziel) {
+  size_t pos = 0;
+  while (pos < wert.size() && (wert[pos] == ' ' || wert[pos] == '\t' || wert[pos] == '\n' || wert[pos] == '\r')) {
+    ++pos;
+  }
+  if (pos < wert.size() && wert[pos] == '+') {
+    ++pos;
+  }
+  if (pos == wert.size()) {
+    return true;
+  }
+  const char* const ende = wert.data() + wert.size();
+  const auto ergebnis = std::from_chars(wert.data() + pos, ende, ziel);
+  if (ergebnis.ec != std::errc() || ergebnis.ptr != ende) {
+    ziel = 0;
+    return false;
+  }
+  return true;
+}
+
+// Liest die Zahl im Attribut `name` von `tag` und merkt sie sich in `ungueltig`, wenn sie ungueltig ist.
+template<typename T>
+void LiesZahl(const XmlTag& tag, std::string_view name, std::string_view wert, T& ziel, std::vector<UngueltigeZahl>& ungueltig) {
+  if (!LiesZahl(wert, ziel)) {
+    ungueltig.push_back(UngueltigeZahl { tag.name, name, wert });
+  }
+}
+
+void LiesVec3(const XmlTag& tag, Vec3& ziel, std::vector<UngueltigeZahl>& ungueltig) {
+  FuerAlleAttribute(tag, [&](std::string_view name, std::string_view wert) {
+    if (name == "X") {
+      LiesZahl(tag, name, wert, ziel.X, ungueltig);
+    } else if (name == "Y") {
+      LiesZahl(tag, name, wert, ziel.Y, ungueltig);
+    } else if (name == "Z") {
+      LiesZahl(tag, name, wert, ziel.Z, ungueltig);
+    }
+  });
+}
+
+// Ersetzt die XML-Entities in einem nicht-destruktiv geparsten Attributwert.
+std::string DekodiereAttribut(std::string_view wert) {
+  std::string result;
+  result.reserve(wert.size());
+  for (size_t i = 0; i < wert.size(); ++i) {
+    if (wert[i] != '&') {
+      result.push_back(wert[i]);
+      continue;
+    }
+    const auto semikolon = wert.find(';', i);
+    if (semikolon == std::string_view::npos) {
+      result.push_back(wert[i]);
+      continue;
+    }
+    const auto entity = wert.substr(i + 1, semikolon - i - 1);
+    if (entity == "amp") {
+      result.push_back('&');
+    } else if (entity == "lt") {
+      result.push_back('<');
+    } else if (entity == "gt") {
+      result.push_back('>');
+    } else if (entity == "quot") {
+      result.push_back('"');
+    } else if (entity == "apos") {
+      result.push_back('\'');
+    } else if (entity.size() >= 2 && entity[0] == '#') {
+      const std::string ziffern(entity.substr(entity[1] == 'x' ? 2 : 1));
+      const auto codepoint = std::strtoul(ziffern.c_str(), nullptr, entity[1] == 'x' ? 16 : 10);
+      // Als UTF-8 kodieren
+      if (codepoint < 0x80) {
+        result.push_back(static_cast<char>(codepoint));
+      } else if (codepoint < 0x800) {
+        result.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+      } else if (codepoint < 0x10000) {
+        result.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+      } else {
+        result.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        result.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+      }
+    } else {
+      result.append(wert.substr(i, semikolon - i + 1));
+    }
+    i = semikolon;
+  }
+  return result;
+}
+
+template<typename RichtungsInfo>
+void LiesRichtungsInfo(XmlLeser& leser, const XmlTag& tag, std::optional<RichtungsInfo>& ziel, std::vector<UngueltigeZahl>& ungueltig) {
+  ziel.emplace();
+  leser.FuerAlleKinder(tag, [&](const XmlTag& signal_tag) {
+    if (signal_tag.name != "Signal" || ziel->Signal) {
+      return;
+    }
+    ziel->Signal = std::make_unique<Signal>();
+    leser.FuerAlleKinder(signal_tag, [&](const XmlTag& frame_tag) {
+      if (frame_tag.name != "SignalFrame") {
+        return;
+      }
+      auto frame = std::make_unique<SignalFrame>();
+      bool pGelesen = false;
+      bool dateiGelesen = false;
+      leser.FuerAlleKinder(frame_tag, [&](const XmlTag& kind) {
+        if (kind.name == "p" && !pGelesen) {
+          LiesVec3(kind, frame->p, ungueltig);
+          pGelesen = true;
+        } else if (kind.name == "Datei" && !dateiGelesen) {
+          FuerAlleAttribute(kind, [&frame](std::string_view name, std::string_view wert) {
+            if (name == "Dateiname") {
+              frame->Datei.Dateiname = DekodiereAttribut(wert);
+            }
+          });
+          dateiGelesen = true;
+        }
+      });
+      ziel->Signal->children_SignalFrame.push_back(std::move(frame));
+    });
+  });
+}
+
+// Ein gelesenes Streckenelement mit der Position seines kr-Attributs, noch nicht nach Nummer einsortiert.
+struct GelesenesElement {
+  std::unique_ptr<StrElement> element;
+  KrPosition krPosition;
+  std::vector<UngueltigeZahl> ungueltigeZahlen;  // als 0 gelesen, meist leer
+};
+
+// Liest ein StrElement und haengt es an `ziel` an. `anfang` ist der Anfang des Dateiinhalts.
+// Elemente ohne oder mit negativer Nummer werden uebersprungen.
+void LiesStrElement(XmlLeser& leser, const XmlTag& tag, const char* anfang, Elementquelle& quelle,
+    std::vector<GelesenesElement>& ziel) {
+  auto str_element = quelle.Neu();
+  std::optional<std::string_view> nr_wert;
+  std::optional<std::string_view> kr_wert;
+  std::vector<UngueltigeZahl> ungueltig;
+  FuerAlleAttribute(tag, [&](std::string_view name, std::string_view wert) {
+    if (name == "Nr") {
+      nr_wert = wert;
+      LiesZahl(tag, name, wert, str_element->Nr, ungueltig);
+    } else if (name == "kr") {
+      kr_wert = wert;
+      LiesZahl(tag, name, wert, str_element->kr, ungueltig);
+    } else if (name == "Anschluss") {
+      LiesZahl(tag, name, wert, str_element->Anschluss, ungueltig);
+    } else if (name == "Fkt") {
+      LiesZahl(tag, name, wert, str_element->Fkt, ungueltig);
+    }
+  });
+  if (!nr_wert || str_element->Nr < 0) {
+    return;
+  }
+
+  bool gGelesen = false;
+  bool bGelesen = false;
+  leser.FuerAlleKinder(tag, [&](const XmlTag& kind) {
+    if (kind.name == "NachNorm" || kind.name == "NachGegen") {
+      auto& nachfolger = (kind.name == "NachNorm" ? str_element->children_NachNorm : str_element->children_NachGegen);
+      nachfolger.emplace_back();
+      FuerAlleAttribute(kind, [&](std::string_view name, std::string_view wert) {
+        if (name == "Nr") {
+          LiesZahl(kind, name, wert, nachfolger.back().Nr, ungueltig);
+        }
+      });
+    } else if (kind.name == "g" && !gGelesen) {
+      LiesVec3(kind, str_element->g, ungueltig);
+      gGelesen = true;
+    } else if (kind.name == "b" && !bGelesen) {
+      LiesVec3(kind, str_element->b, ungueltig);
+      bGelesen = true;
+    } else if (kind.name == "InfoNormRichtung" && !str_element->InfoNormRichtung) {
+      LiesRichtungsInfo(leser, kind, str_element->InfoNormRichtung, ungueltig);
+    } else if (kind.name == "InfoGegenRichtung" && !str_element->InfoGegenRichtung) {
+      LiesRichtungsInfo(leser, kind, str_element->InfoGegenRichtung, ungueltig);
+    }
+  });
+
+  KrPosition krPosition;
+  if (kr_wert) {
+    krPosition.anfang = kr_wert->data() - anfang;
+    krPosition.ende = krPosition.anfang + kr_wert->size();
+    krPosition.vorhanden = true;
+  } else {
+    // Hinter das schliessende Anfuehrungszeichen des Nr-Attributs
+    krPosition.anfang = krPosition.ende = (nr_wert->data() - anfang) + nr_wert->size() + 1;
+    krPosition.vorhanden = false;
+  }
+  ziel.push_back(GelesenesElement { std::move(str_element), krPosition, std::move(ungueltig) });
+}
+
+// Liest die Streckenelemente unter `strecke_tag`, alle anderen Kinder werden uebersprungen.
+void LiesStreckenkinder(XmlLeser& leser, const XmlTag& strecke_tag, const char* anfang, Elementquelle& quelle,
+    std::vector<GelesenesElement>& ziel) {
+  leser.FuerAlleKinder(strecke_tag, [&](const XmlTag& kind) {
+    if (kind.name == "StrElement") {
+      LiesStrElement(leser, kind, anfang, quelle, ziel);
+    }
+  });
+}
+
+// Liest Zusi -> Strecke -> StrElement bis zum Ende des Dokuments oder bis zur Grenze des Lesers.
+// Gibt die Tiefe innerhalb der Strecke zurueck, wenn die Grenze zwischen zwei Kindern der Strecke erreicht wurde,
+// sonst 0.
+size_t LiesDokument(XmlLeser& leser, Streckendatei& datei, Elementquelle& quelle, std::vector<GelesenesElement>& elemente) {
+  size_t tiefeGrenze = 0;
+  leser.FuerAlleElemente([&](const XmlTag& zusi_tag) {
+    if (zusi_tag.name != "Zusi" || datei.zusi) {
+      return;
+    }
+    datei.zusi = std::make_unique<Zusi>();
+    leser.FuerAlleKinder(zusi_tag, [&](const XmlTag& strecke_tag) {
+      if (strecke_tag.name != "Strecke" || datei.zusi->Strecke) {
+        return;
+      }
+      datei.zusi->Strecke = std::make_unique<Strecke>();
+      const size_t tiefe = leser.tiefe();
+      LiesStreckenkinder(leser, strecke_tag, datei.inhalt.data(), quelle, elemente);
+      if (leser.grenzeErreicht() && leser.tiefe() == tiefe) {
+        tiefeGrenze = tiefe;
+      }
+    });
+  });
+  return tiefeGrenze;
+}
+
+// Position des naechsten Start-Tags eines StrElement ab `pos`, sonst npos.
+// Kann auch in Kommentaren oder CDATA liegen, das faellt erst beim Lesen der Abschnitte auf.
+size_t SucheStrElement(std::string_view text, size_t pos) {
+  constexpr std::string_view muster = "<StrElement";
+  while ((pos = text.find(muster, pos)) != std::string_view::npos) {
+    const size_t danach = pos + muster.size();
+    if (danach < text.size() && (static_cast<unsigned char>(text[danach]) <= ' ' || text[danach] == '>' || text[danach] == '/')) {
+      return pos;
+    }
+    pos = danach;
+  }
+  return std::string_view::npos;
+}
+
+// Liest die Kinder der Strecke ab `anfang` (erstes StrElement, auf Tiefe `tiefe`) bis zum Dokumentende
+// in Abschnitten parallel ein. Die Abschnitte beginnen jeweils an einem StrElement und werden in Dateireihenfolge
+// an `elemente` angehaengt. Gibt false zurueck, wenn ein Abschnitt nicht genau an der Grenze des naechsten
+// endet oder einen XML-Fehler enthaelt; dann muss die Datei sequentiell gelesen werden.
+bool LiesStreckenkinderParallel(const Streckendatei& datei, size_t anfang, size_t tiefe, size_t anzahlAbschnitte,
+    Arbeitspool& pool, std::vector<GelesenesElement>& elemente) {
+  const std::string_view text(datei.inhalt.data(), datei.inhalt.size());
+  std::vector<size_t> grenzen { anfang };
+  for (size_t i = 1; i < anzahlAbschnitte; ++i) {
+    const size_t grenze = SucheStrElement(text, std::max(grenzen.back() + 1, anfang + i * (text.size() - anfang) / anzahlAbschnitte));
+    if (grenze == std::string_view::npos) {
+      break;
+    }
+    grenzen.push_back(grenze);
+  }
+  grenzen.push_back(std::string_view::npos);
+
+  const size_t anzahl = grenzen.size() - 1;
+  std::vector<std::vector<GelesenesElement>> abschnitte(anzahl);
+  std::vector<char> gueltig(anzahl, false);
+  pool.ParallelFuer(anzahl, [&](size_t i) {
+    try {
+      XmlLeser leser(text, grenzen[i], tiefe, grenzen[i + 1]);
+      Elementquelle quelle(datei.speicher);
+      LiesStreckenkinder(leser, XmlTag {}, datei.inhalt.data(), quelle, abschnitte[i]);
+      if (i + 1 < anzahl) {
+        gueltig[i] = leser.grenzeErreicht() && leser.tiefe() == tiefe && leser.position() == grenzen[i + 1];
+      } else {
+        // Der letzte Abschnitt endet mit der Strecke, der Rest der Datei wird nur noch auf Fehler geprueft
+        gueltig[i] = (leser.tiefe() == tiefe - 1);
+        leser.UeberspringeRest();
+      }
+    } catch (const XmlFehler&) {
+      gueltig[i] = false;
+    }
+  });
+
+  if (std::find(gueltig.begin(), gueltig.end(), false) != gueltig.end()) {
+    return false;
+  }
+  for (auto& abschnitt : abschnitte) {
+    std::move(abschnitt.begin(), abschnitt.end(), std::back_inserter(elemente));
+  }
+  return true;
+}
+
+// Warnt vor den als 0 gelesenen Zahlen, hoechstens MAX_MELDUNGEN mal pro Datei.
+void MeldeUngueltigeZahlen(const std::vector<GelesenesElement>& elemente, Protokoll& log) {
+  constexpr size_t MAX_MELDUNGEN = 10;
+  if (!log.fehler()) {
+    return;
+  }
+  size_t anzahl = 0;
+  for (const auto& gelesen : elemente) {
+    for (const auto& zahl : gelesen.ungueltigeZahlen) {
+      if (++anzahl <= MAX_MELDUNGEN) {
+        log << "Element " << gelesen.element->Nr << ": Ungueltige Zahl \"" << zahl.wert << "\" in " << zahl.tag << "." << zahl.attribut
+          << ", als 0 gelesen\n";
+      }
+    }
+  }
+  if (anzahl > MAX_MELDUNGEN) {
+    log << (anzahl - MAX_MELDUNGEN) << " weitere ungueltige Zahlen als 0 gelesen\n";
+  }
+}
+
+// Wie im Zusi-Parser steht jedes Streckenelement an dem Index, der seiner Nummer entspricht.
+// Bei doppelten Nummern gewinnt das spaetere Element.
+void Einsortieren(std::vector<GelesenesElement>& elemente, Streckendatei& datei) {
+  auto& str_elemente = datei.zusi->Strecke->children_StrElement;
+  size_t anzahl = str_elemente.size();
+  for (const auto& gelesen : elemente) {
+    anzahl = std::max(anzahl, static_cast<size_t>(gelesen.element->Nr) + 1);
+  }
+  str_elemente.resize(anzahl);
+  datei.krPositionen.resize(anzahl);
+  for (auto& gelesen : elemente) {
+    const auto nr = static_cast<size_t>(gelesen.element->Nr);
+    str_elemente[nr] = std::move(gelesen.element);
+    datei.krPositionen[nr] = gelesen.krPosition;
+  }
+}
+
+// Schreibt eine Ausgabedatei, die groesstenteils aus unveraenderten Bereichen der Eingabedatei besteht.
+// Kleine Stuecke werden gepuffert. Grosse unveraenderte Bereiche werden unter Linux per copy_file_range
+// innerhalb des Kernels aus der Eingabedatei kopiert (auf Dateisystemen mit Reflinks ohne die Daten
+// ueberhaupt zu kopieren), ansonsten direkt aus dem Dateiinhalt im Speicher geschrieben.
+class Ausgabedatei {
+ public:
+  Ausgabedatei(const std::string& dateiname, const Streckendatei& eingabe) : m_eingabe(eingabe) {
+    m_puffer.reserve(PUFFERGROESSE);
+#ifdef __linux__
+    m_fd = ::open(dateiname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    m_ok = (m_fd >= 0);
+    // copy_file_range nur verwenden, wenn die Eingabedatei noch dem eingelesenen Inhalt entspricht
+    m_eingabeFd = ::open(eingabe.dateiname.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (m_eingabeFd >= 0 && (::fstat(m_eingabeFd, &st) != 0 || static_cast<size_t>(st.st_size) != eingabe.inhalt.size())) {
+      ::close(m_eingabeFd);
+      m_eingabeFd = -1;
+    }
+#else
+    m_datei = std::fopen(dateiname.c_str(), "wb");
+    m_ok = (m_datei != nullptr);
+#endif
+  }
+
+  ~Ausgabedatei() {
+    Schliesse();
+  }
+
+  void Schreibe(std::string_view text) {
+    m_laenge += text.size();
+    if (m_puffer.size() + text.size() > PUFFERGROESSE) {
+      Leere();
+    }
+    if (text.size() >= PUFFERGROESSE) {
+      SchreibeDirekt(text.data(), text.size());
+    } else {
+      m_puffer.append(text);
+    }
+  }
+
+  // Haengt `wert` direkt im Puffer in der kuerzesten Dezimaldarstellung ohne Exponent an, die beim Einlesen
+  // wieder genau `wert` ergibt (unabhaengig von der Locale). Nur sehr grosse oder sehr kleine Werte,
+  // die so nicht in ZAHLLAENGE Zeichen passen, werden mit Exponent geschrieben.
+  // Der Parameter ist bewusst float und nicht double: Die Kruemmung wird vorher auf float (den Typ von
+  // StrElement::kr) gerundet, denn nur fuer diesen Wert garantiert die kuerzeste Darstellung das Wiedereinlesen
+  // ohne Abweichung. Die kuerzeste Darstellung des double-Werts waere bis zu 17 Stellen lang, ohne dass
+  // der Leser davon mehr als float-Genauigkeit behaelt.
+  void SchreibeZahl(float wert) {
+    if (m_puffer.size() + ZAHLLAENGE > PUFFERGROESSE) {
+      Leere();
+    }
+    const size_t alt = m_puffer.size();
+    m_puffer.resize(alt + ZAHLLAENGE);
+    char* const anfang = m_puffer.data() + alt;
+    auto ergebnis = std::to_chars(anfang, anfang + ZAHLLAENGE, wert, std::chars_format::fixed);
+    if (ergebnis.ec != std::errc()) {
+      ergebnis = std::to_chars(anfang, anfang + ZAHLLAENGE, wert);
+    }
+    m_puffer.resize(ergebnis.ptr - m_puffer.data());
+    m_laenge += m_puffer.size() - alt;
+  }
+
+  // Haengt den Bereich [anfang, ende) der Eingabedatei an.
+  void KopiereEingabe(size_t anfang, size_t ende) {
+    const size_t laenge = ende - anfang;
+#ifdef __linux__
+    if (laenge >= PUFFERGROESSE && m_eingabeFd >= 0 && m_ok) {
+      Leere();
+      loff_t offsetEingabe = anfang;
+      size_t rest = laenge;
+      while (rest > 0) {
+        const auto kopiert = ::copy_file_range(m_eingabeFd, &offsetEingabe, m_fd, nullptr, rest, 0);
+        if (kopiert <= 0) {
+          break;  // z.B. EXDEV oder ENOSYS: Rest normal schreiben
+        }
+        rest -= kopiert;
+      }
+      m_laenge += laenge - rest;
+      anfang = ende - rest;
+      if (rest == 0) {
+        return;
+      }
+    }
+#endif
+    Schreibe({ m_eingabe.inhalt.data() + anfang, ende - anfang });
+  }
+
+  // Anzahl der bisher angehaengten Bytes
+  size_t laenge() const { return m_laenge; }
+
+  bool Schliesse() {
+    Leere();
+#ifdef __linux__
+    if (m_eingabeFd >= 0) {
+      ::close(m_eingabeFd);
+      m_eingabeFd = -1;
+    }
+    if (m_fd >= 0) {
+      m_ok = (::close(m_fd) == 0) && m_ok;
+      m_fd = -1;
+    }
+#else
+    if (m_datei) {
+      m_ok = (std::fclose(m_datei) == 0) && m_ok;
+      m_datei = nullptr;
+    }
+#endif
+    return m_ok;
+  }
+
+ private:
+  static constexpr size_t PUFFERGROESSE = 1 << 16;
+  static constexpr size_t ZAHLLAENGE = 64;  // Platz fuer eine Zahl in SchreibeZahl, mit Exponent reichen immer 15 Zeichen
+
+  void Leere() {
+    SchreibeDirekt(m_puffer.data(), m_puffer.size());
+    m_puffer.clear();
+  }
+
+  void SchreibeDirekt(const char* daten, size_t laenge) {
+    if (!m_ok) {
+      return;
+    }
+#ifdef __linux__
+    while (laenge > 0) {
+      const auto geschrieben = ::write(m_fd, daten, laenge);
+      if (geschrieben < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        m_ok = false;
+        return;
+      }
+      daten += geschrieben;
+      laenge -= geschrieben;
+    }
+#else
+    m_ok = (std::fwrite(daten, 1, laenge, m_datei) == laenge);
+#endif
+  }
+
+  const Streckendatei& m_eingabe;
+  std::string m_puffer;
+  size_t m_laenge = 0;
+  bool m_ok = false;
+#ifdef __linux__
+  int m_fd = -1;
+  int m_eingabeFd = -1;
+#else
+  std::FILE* m_datei = nullptr;
+#endif
+};
+
+}  // namespace
+
+namespace {
+
+std::unique_ptr<Streckendatei> LiesStreckendatei(const std::string& dateiname, const Leseoptionen& optionen,
+    Arbeitspool* pool, Protokoll& log) {
+  auto result = std::make_unique<Streckendatei>();
+  result->dateiname = dateiname;
+  result->speicher = optionen.speicher;
+
+  if (!result->inhalt.Lies(dateiname, optionen.mmap)) {
+    if (log.fehler()) {
+      log << "Fehler beim Lesen von " << dateiname << "\n";
+    }
+    return nullptr;
+  }
+  Profil::Zaehle(Zaehler::BytesGelesen, result->inhalt.size());
+
+  // Es wird nur der benoetigte Teil der Datei in Objekte umgesetzt (Zusi -> Strecke -> StrElement),
+  // alle anderen Elemente werden beim Lesen uebersprungen, ohne dass ein Dokumentbaum entsteht.
+  // Der Dateiinhalt bleibt unveraendert (der eingeblendete Speicher ist nur lesbar),
+  // die Attributwerte zeigen direkt in den Dateiinhalt und koennen beim Schreiben ersetzt werden.
+  //
+  // Die Streckenelemente machen fast die ganze Datei aus und stehen nebeneinander in der Strecke.
+  // Bei grossen Dateien wird deshalb nur der Teil vor dem ersten StrElement sequentiell gelesen,
+  // der Rest in Abschnitten, die jeweils an einem StrElement beginnen, parallel.
+  const std::string_view text(result->inhalt.data(), result->inhalt.size());
+  std::vector<GelesenesElement> elemente;
+  Elementquelle quelle(optionen.speicher);
+  try {
+    const size_t erstesElement = SucheStrElement(text, 0);
+    const size_t anzahlAbschnitte = (pool && erstesElement != std::string_view::npos)
+        ? std::min<size_t>(4 * pool->anzahlThreads(), (text.size() - erstesElement) / MIN_ABSCHNITTSGROESSE)
+        : 0;
+    bool gelesen = false;
+    if (anzahlAbschnitte > 1) {
+      XmlLeser leser(text, 0, 0, erstesElement);
+      const size_t tiefe = LiesDokument(leser, *result, quelle, elemente);
+      gelesen = (tiefe > 0) && LiesStreckenkinderParallel(*result, erstesElement, tiefe, anzahlAbschnitte, *pool, elemente);
+      if (!gelesen) {
+        result->zusi.reset();
+        elemente.clear();
+      }
+    }
+    if (!gelesen) {
+      XmlLeser leser(text);
+      LiesDokument(leser, *result, quelle, elemente);
+    }
+  } catch (const XmlFehler& e) {
+    if (log.fehler()) {
+      log << "XML-Fehler: " << e.what() << " (Byte " << e.position() << ")\n";
+    }
+    return nullptr;
+  }
+
+  if (!result->zusi) {
+    return nullptr;
+  }
+  if (result->zusi->Strecke) {
+    MeldeUngueltigeZahlen(elemente, log);
+    Einsortieren(elemente, *result);
+  }
+  return result;
+}
+
+}  // namespace
+
+Streckendatei::~Streckendatei() {
+  if (speicher && zusi && zusi->Strecke) {
+    speicher->Zurueckgeben(zusi->Strecke->children_StrElement);
+  }
+}
+
+std::unique_ptr<Streckendatei> LiesStreckendatei(const std::string& dateiname, const Leseoptionen& optionen, Protokoll& log) {
+  return LiesStreckendatei(dateiname, optionen, nullptr, log);
+}
+
+std::unique_ptr<Streckendatei> LiesStreckendatei(const std::string& dateiname, const Leseoptionen& optionen,
+    Arbeitspool& pool, Protokoll& log) {
+  return LiesStreckendatei(dateiname, optionen, &pool, log);
+}
+
+bool SchreibeNeueKruemmungen(const Streckendatei& datei, const std::string& dateinameNeu,
+    const Kruemmungstabelle& kruemmungenNeu, Protokoll& log) {
+  // Zu ersetzende Bereiche in Dateireihenfolge. Ueblicherweise sind die Elemente in der Datei
+  // nach Nummer sortiert, dann ist kein Sortieren noetig.
+  std::vector<std::pair<size_t, double>> ersetzungen;
+  ersetzungen.reserve(kruemmungenNeu.anzahlGesetzt());
+  kruemmungenNeu.FuerAlleGesetzten([&datei, &ersetzungen](size_t nr, double kr) {
+    if (nr < datei.krPositionen.size()) {
+      ersetzungen.emplace_back(nr, kr);
+    }
+  });
+  const auto& vorPosition = [&datei](const auto& lhs, const auto& rhs) {
+    return datei.krPositionen[lhs.first].anfang < datei.krPositionen[rhs.first].anfang;
+  };
+  if (!std::is_sorted(ersetzungen.begin(), ersetzungen.end(), vorPosition)) {
+    std::sort(ersetzungen.begin(), ersetzungen.end(), vorPosition);
+  }
+
+  Ausgabedatei ausgabe(dateinameNeu, datei);
+  size_t pos = 0;
+  for (const auto& [nr, krNeu] : ersetzungen) {
+    const auto& krPosition = datei.krPositionen[nr];
+    // kr ist in Zusi ein Single-Wert; mehr Stellen als fuer float noetig wuerden nur Rundungsrauschen schreiben
+    const float kr = static_cast<float>(krNeu);
+    ausgabe.KopiereEingabe(pos, krPosition.anfang);
+    if (krPosition.vorhanden) {
+      ausgabe.SchreibeZahl(kr);
+    } else {
+      ausgabe.Schreibe(" kr=\"");
+      ausgabe.SchreibeZahl(kr);
+      ausgabe.Schreibe("\"");
+    }
+    pos = krPosition.ende;
+  }
+  ausgabe.KopiereEingabe(pos, datei.inhalt.size());
+
+  if (!ausgabe.Schliesse()) {
+    if (log.fehler()) {
+      log << "Fehler beim Schreiben der ST3-Datei " << dateinameNeu << "\n";
+    }
+    return false;
+  }
+  Profil::Zaehle(Zaehler::BytesGeschrieben, ausgabe.laenge());
+  if (log.normal()) {
+    log << "Neue ST3-Datei geschrieben: " << dateinameNeu << "\n";
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include "arbeitspool.hpp"
+#include "dateiinhalt.hpp"
+#include "elementspeicher.hpp"
+#include "kruemmungstabelle.hpp"
+#include "protokoll.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Position des kr-Attributs eines StrElement im Dateiinhalt.
+// Ist das Attribut nicht vorhanden, ist anfang == ende die Stelle direkt hinter dem Nr-Attribut,
+// an der es beim Schreiben eingefuegt wird.
+struct KrPosition {
+  size_t anfang = 0;
+  size_t ende = 0;
+  bool vorhanden = false;
+};
+
+// Eine einmal eingelesene Streckendatei. Der Zusi-Baum enthaelt nur die Teile der Datei,
+// die fuer die Bogenweichenberechnung benoetigt werden (Streckenelemente mit Geometrie, Verknuepfungen
+// und Signalframes der Richtungsinformationen).
+struct Streckendatei {
+  std::string dateiname;
+  Dateiinhalt inhalt;
+  std::unique_ptr<Zusi> zusi;
+  std::vector<KrPosition> krPositionen;  // Index: Nr des Streckenelements
+  Elementspeicher* speicher = nullptr;   // Nimmt beim Zerstoeren die Streckenelemente auf, falls gesetzt
+
+  ~Streckendatei();
+};
+
+struct Leseoptionen {
+  bool mmap = true;  // Datei per mmap einblenden statt in den Speicher zu lesen
+  Elementspeicher* speicher = nullptr;  // Streckenelemente aus diesem Speicher wiederverwenden (Stapelbetrieb)
+};
+
+// Liest die Streckendatei `dateiname` mit einem einzigen Parser-Durchlauf ein.
+// Gibt bei Fehlern nullptr zurueck und schreibt eine Meldung nach `log`.
+std::unique_ptr<Streckendatei> LiesStreckendatei(const std::string& dateiname, const Leseoptionen& optionen, Protokoll& log);
+
+// Wie oben, bei grossen Dateien werden die Streckenelemente aber abschnittsweise auf den Threads von `pool` gelesen.
+// Das Ergebnis ist dasselbe wie beim sequentiellen Lesen.
+std::unique_ptr<Streckendatei> LiesStreckendatei(const std::string& dateiname, const Leseoptionen& optionen,
+    Arbeitspool& pool, Protokoll& log);
+
+// Schreibt den Inhalt von `datei` nach `dateinameNeu`, wobei die Kruemmungen der Streckenelemente
+// in `kruemmungenNeu` ersetzt werden. Alle anderen Bytes werden unveraendert kopiert,
+// der Aufwand haengt im Wesentlichen nur von der Anzahl der geaenderten Elemente ab.
+// Die Kruemmungen werden auf float (den Typ von StrElement::kr) gerundet und in der kuerzesten Darstellung
+// geschrieben, die beim Einlesen genau diesen Wert ergibt.
+// Gibt false zurueck, wenn die Datei nicht geschrieben werden konnte.
+bool SchreibeNeueKruemmungen(const Streckendatei& datei, const std::string& dateinameNeu,
+    const Kruemmungstabelle& kruemmungenNeu, Protokoll& log);
@@ -0,0 +1,132 @@
+// Prueft das Einlesen der Zahlen in Streckendateien: Attributwerte sind nicht nullterminiert und werden
+// unabhaengig von der C-Locale gelesen. Ungueltige Zahlen werden wie vom Zusi-Parser als 0 gelesen statt als Teilwert,
+// mit einer Warnung, die das Element nennt.
+// Die Testdateien werden im aktuellen Verzeichnis angelegt.
+
+#include "protokoll.hpp"
+#include "streckendatei.hpp"
+
+#include <clocale>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int anzahlFehler = 0;
+
+void Pruefe(bool bedingung, const char* beschreibung) {
+  if (!bedingung) {
+    std::cout << "FEHLER: " << beschreibung << "\n";
+    ++anzahlFehler;
+  }
+}
+
+const std::string DATEINAME = "streckendatei_test.st3";
+
+void SchreibeDatei(const std::string& inhalt) {
+  std::ofstream datei(DATEINAME, std::ios::binary | std::ios::trunc);
+  datei << inhalt;
+}
+
+std::unique_ptr<Streckendatei> Lies(const std::string& inhalt, bool mmap, std::ostream& meldungen) {
+  SchreibeDatei(inhalt);
+  Protokoll log(meldungen, Ausgabestufe::Fehler);
+  Leseoptionen optionen;
+  optionen.mmap = mmap;
+  return LiesStreckendatei(DATEINAME, optionen, log);
+}
+
+const std::string KOPF = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Zusi>\n<Info DateiTyp=\"Strecke\"/>\n<Strecke>\n";
+const std::string ENDE = "</StrElement></Strecke></Zusi>";
+
+// Die Z-Koordinate des Endes b ist die letzte Zahl der Datei. Ihre letzte Ziffer steht direkt vor dem
+// schliessenden Anfuehrungszeichen, danach folgen nur noch die schliessenden Tags ohne Zeilenumbruch.
+std::string Zahlendatei() {
+  return KOPF
+    + "<StrElement Nr=\"7\" kr=\"-1.5E-5\" Anschluss=' 3' Fkt=\"+4\">\n"
+    + "<NachNorm Nr=\"8\"/>\n"
+    + "<g X=\"-12.25\" Y=\"1e3\" Z=\"0\"/>\n"
+    + "<b X=\"-4.25\" Y=\"1000.5\" Z=\"3.1415927\"/>" + ENDE;
+}
+
+void PruefeZahlen(const Streckendatei* datei, const char* variante) {
+  std::string beschreibung = std::string(variante) + ": Datei gelesen";
+  const bool gelesen = datei && datei->zusi && datei->zusi->Strecke && datei->zusi->Strecke->children_StrElement.size() == 8
+      && datei->zusi->Strecke->children_StrElement[7];
+  Pruefe(gelesen, beschreibung.c_str());
+  if (!gelesen) {
+    return;
+  }
+  const auto& el = *datei->zusi->Strecke->children_StrElement[7];
+  beschreibung = std::string(variante) + ": Werte der Attribute";
+  Pruefe(el.Nr == 7 && el.kr == -1.5e-5f && el.Anschluss == 3 && el.Fkt == 4, beschreibung.c_str());
+  beschreibung = std::string(variante) + ": Nachfolger";
+  Pruefe(el.children_NachNorm.size() == 1 && el.children_NachNorm[0].Nr == 8, beschreibung.c_str());
+  beschreibung = std::string(variante) + ": Koordinaten, letzte Zahl am Ende der Datei";
+  Pruefe(el.g.X == -12.25f && el.g.Y == 1000.0f && el.g.Z == 0.0f
+      && el.b.X == -4.25f && el.b.Y == 1000.5f && el.b.Z == 3.1415927f, beschreibung.c_str());
+}
+
+}  // namespace
+
+int main() {
+  for (const bool mmap : { true, false }) {
+    std::ostringstream meldungen;
+    const auto datei = Lies(Zahlendatei(), mmap, meldungen);
+    PruefeZahlen(datei.get(), mmap ? "mmap" : "Puffer");
+  }
+
+  // Mit deutscher Locale liest strtod "3.1415927" als 3. from_chars haengt nicht von der Locale ab.
+  if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") || std::setlocale(LC_NUMERIC, "de_DE") || std::setlocale(LC_NUMERIC, "German")) {
+    std::ostringstream meldungen;
+    const auto datei = Lies(Zahlendatei(), true, meldungen);
+    PruefeZahlen(datei.get(), "Locale de_DE");
+    std::setlocale(LC_NUMERIC, "C");
+  } else {
+    std::cout << "Locale de_DE nicht vorhanden, Test mit deutscher Locale uebersprungen\n";
+  }
+
+  // Ungueltige Zahlen, auch als letzte Zahl der Datei
+  for (const char* wert : { "1,5", "0.5x", "abc", "1e999" }) {
+    std::ostringstream meldungen;
+    const auto datei = Lies(KOPF + "<StrElement Nr=\"1\">\n<b X=\"0\" Y=\"2\" Z=\"" + wert + "\"/>" + ENDE, true, meldungen);
+    std::string beschreibung = std::string("Ungueltige Zahl ") + wert + " wird als 0 gelesen";
+    Pruefe(datei && datei->zusi->Strecke->children_StrElement.size() == 2 && datei->zusi->Strecke->children_StrElement[1]
+        && datei->zusi->Strecke->children_StrElement[1]->b.Y == 2.0f
+        && datei->zusi->Strecke->children_StrElement[1]->b.Z == 0.0f, beschreibung.c_str());
+    beschreibung = std::string("Ungueltige Zahl ") + wert + " wird mit Element und Attribut gemeldet";
+    Pruefe(meldungen.str().find(std::string("Element 1: Ungueltige Zahl \"") + wert + "\" in b.Z") != std::string::npos,
+        beschreibung.c_str());
+  }
+
+  // Ungueltige Nummer eines Nachfolgers, die Warnung nennt das Element
+  {
+    std::ostringstream meldungen;
+    const auto datei = Lies(KOPF + "<StrElement Nr=\"3\" kr=\"0.5.1\">\n<NachNorm Nr=\"4a\"/>" + ENDE, true, meldungen);
+    Pruefe(datei && datei->zusi->Strecke->children_StrElement.size() == 4 && datei->zusi->Strecke->children_StrElement[3]
+        && datei->zusi->Strecke->children_StrElement[3]->kr == 0.0f
+        && datei->zusi->Strecke->children_StrElement[3]->children_NachNorm.size() == 1
+        && datei->zusi->Strecke->children_StrElement[3]->children_NachNorm[0].Nr == 0, "Ungueltige Nummer wird als 0 gelesen");
+    Pruefe(meldungen.str().find("Element 3: Ungueltige Zahl \"0.5.1\" in StrElement.kr") != std::string::npos
+        && meldungen.str().find("Element 3: Ungueltige Zahl \"4a\" in NachNorm.Nr") != std::string::npos,
+        "Ungueltige Zahlen in Element und Nachfolger gemeldet");
+  }
+
+  // Leere Werte lassen den Standardwert stehen
+  {
+    std::ostringstream meldungen;
+    const auto datei = Lies(KOPF + "<StrElement Nr=\"1\" kr=\"\">\n<b X=\"\" Y=\"2\"/>" + ENDE, true, meldungen);
+    Pruefe(datei && datei->zusi->Strecke->children_StrElement.size() == 2 && datei->zusi->Strecke->children_StrElement[1]
+        && datei->zusi->Strecke->children_StrElement[1]->kr == 0.0f
+        && datei->zusi->Strecke->children_StrElement[1]->b.Y == 2.0f, "Leere Werte werden uebersprungen");
+  }
+
+  std::remove(DATEINAME.c_str());
+  if (anzahlFehler == 0) {
+    std::cout << "streckendatei_test: ok\n";
+  }
+  return anzahlFehler == 0 ? 0 : 1;
+}
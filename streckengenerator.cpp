@@ -0,0 +1,363 @@
+#include "streckengenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <random>
+#include <set>
+
+namespace {
+
+constexpr double LAENGE_VERZWEIGUNG = 3.0;  // Laenge des Verzweigungselements in m
+constexpr double LAENGE_STRANG = 8.0;       // Laenge der Elemente beider Straenge in m
+constexpr double LAENGE_GLEIS = 20.0;       // Laenge der Elemente zwischen den Weichen in m
+constexpr double SPIRALE_RADIUS = 2000.0;   // Anfangsradius der Spirale, auf der das Gleis liegt, in m
+constexpr double SPIRALE_ABSTAND = 50.0;    // Abstand benachbarter Windungen der Spirale in m
+constexpr int FKT_WEICHE = 1 << 2;
+constexpr const char* ZEILENENDE = "\r\n";  // wie in von Zusi geschriebenen Dateien
+
+struct Punkt {
+  double x = 0;
+  double y = 0;
+};
+
+// Zahl mit hoechstens 6 Nachkommastellen, ohne Nullen am Ende
+std::string Zahl(double wert, char dezimaltrenner = '.') {
+  char puffer[64];
+  int laenge = std::snprintf(puffer, sizeof(puffer), "%.6f", wert);
+  while (laenge > 0 && puffer[laenge - 1] == '0') {
+    --laenge;
+  }
+  if (laenge > 0 && puffer[laenge - 1] == '.') {
+    --laenge;
+  }
+  std::string result(puffer, laenge);
+  if (result == "-0") {
+    result = "0";
+  }
+  std::replace(result.begin(), result.end(), '.', dezimaltrenner);
+  return result;
+}
+
+// Schreibt die Streckenelemente einer Datei. Elemente werden in der Reihenfolge ihrer Nummern geschrieben.
+class Elementschreiber {
+ public:
+  explicit Elementschreiber(std::ostream& ausgabe) : m_ausgabe(ausgabe) {}
+
+  void Kopf() {
+    m_ausgabe << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << ZEILENENDE
+      << "<Zusi>" << ZEILENENDE
+      << "<Info DateiTyp=\"Strecke\" Version=\"A.1\" MinVersion=\"A.1\">" << ZEILENENDE
+      << "<AutorEintrag AutorID=\"1\" AutorName=\"Streckengenerator\"/>" << ZEILENENDE
+      << "</Info>" << ZEILENENDE
+      << "<Strecke RekTiefe=\"2\">" << ZEILENENDE
+      << "<UTM UTM_WE=\"500\" UTM_NS=\"5000\" UTM_Zone=\"32\" UTM_Zone2=\"U\"/>" << ZEILENENDE;
+  }
+
+  void Fuss() {
+    m_ausgabe << "</Strecke>" << ZEILENENDE << "</Zusi>" << ZEILENENDE;
+  }
+
+  // `nachGegen` == 0: kein Vorgaenger. `signaldateien`: Signalframes des Weichensignals in Normrichtung,
+  // das erste an Position (0, 0, 0).
+  void Element(size_t nr, Punkt g, Punkt b, double kr, int fkt, std::initializer_list<size_t> nachNorm, size_t nachGegen,
+      std::initializer_list<std::string> signaldateien = {}) {
+    std::string& text = m_text;
+    text.clear();
+    text += "<StrElement Nr=\"";
+    text += std::to_string(nr);
+    text += '"';
+    if (kr != 0) {
+      text += " kr=\"" + Zahl(kr) + '"';
+    }
+    if (fkt != 0) {
+      text += " Fkt=\"" + std::to_string(fkt) + '"';
+    }
+    if (nachGegen != 0) {
+      // Der Vorgaenger ist an seinem Ende b angeschlossen (Bit 8 + Index des Nachfolgers in NachGegen).
+      text += " Anschluss=\"256\"";
+    }
+    text += " spTrass=\"16.666\">";
+    text += ZEILENENDE;
+    if (signaldateien.size() > 0) {
+      text += "<InfoNormRichtung vMax=\"16.666\" km=\"1.2\" pos=\"1\">";
+      text += ZEILENENDE;
+      text += "<Signal NameBetriebsstelle=\"Bf\" Stellwerk=\"Stw\">";
+      text += ZEILENENDE;
+      size_t index = 0;
+      for (const auto& datei : signaldateien) {
+        text += "<SignalFrame WeichenbaugruppeIndex=\"" + std::to_string(index) + "\">";
+        text += ZEILENENDE;
+        text += (index == 0) ? "<p/>" : "<p X=\"3\" Y=\"1\"/>";
+        text += ZEILENENDE;
+        text += "<Datei Dateiname=\"" + datei + "\"/>";
+        text += ZEILENENDE;
+        text += "</SignalFrame>";
+        text += ZEILENENDE;
+        ++index;
+      }
+      text += "</Signal>";
+      text += ZEILENENDE;
+      text += "</InfoNormRichtung>";
+      text += ZEILENENDE;
+    }
+    text += "<g X=\"" + Zahl(g.x) + "\" Y=\"" + Zahl(g.y) + "\" Z=\"0.5\"/>";
+    text += ZEILENENDE;
+    text += "<b X=\"" + Zahl(b.x) + "\" Y=\"" + Zahl(b.y) + "\" Z=\"0.5\"/>";
+    text += ZEILENENDE;
+    for (const size_t nf : nachNorm) {
+      text += "<NachNorm Nr=\"" + std::to_string(nf) + "\"/>";
+      text += ZEILENENDE;
+    }
+    if (nachGegen != 0) {
+      text += "<NachGegen Nr=\"" + std::to_string(nachGegen) + "\"/>";
+      text += ZEILENENDE;
+    }
+    text += "</StrElement>";
+    text += ZEILENENDE;
+    m_ausgabe.write(text.data(), text.size());
+  }
+
+ private:
+  std::ostream& m_ausgabe;
+  std::string m_text;
+};
+
+// Endpunkt eines Kreisbogens der Laenge `laenge` mit Kruemmung `kr`, der in `p` mit Richtung `richtung` beginnt.
+// `richtung` enthaelt danach die Richtung am Ende.
+Punkt Bogen(Punkt p, double& richtung, double laenge, double kr) {
+  const double sehne = richtung + kr * laenge / 2;
+  richtung += kr * laenge;
+  return Punkt { p.x + laenge * std::cos(sehne), p.y + laenge * std::sin(sehne) };
+}
+
+// Schreibt eine Weiche ab Element `start` (Verzweigungselement, dann STRANGLAENGE Elemente des geraden,
+// dann des abzweigenden Strangs) und gibt das Ende des geraden Strangs zurueck. `richtung` ist danach die
+// Richtung am Ende des geraden Strangs. `weiter`: Nachfolger des geraden Strangs (0 = keiner).
+// `streuung` liefert fuer jedes gekruemmte Element einen Faktor fuer dessen Kruemmung.
+template<typename Streuung>
+Punkt SchreibeWeiche(Elementschreiber& schreiber, size_t start, Punkt p, double& richtung, size_t vorher, size_t weiter,
+    double krGerade, double krAbzweigend, std::initializer_list<std::string> signaldateien, Streuung&& streuung) {
+  double richtungStrang = richtung;
+  const Punkt verzweigung = Bogen(p, richtungStrang, LAENGE_VERZWEIGUNG, 0);
+  schreiber.Element(start, p, verzweigung, 0, FKT_WEICHE, { start + 1, start + 1 + STRANGLAENGE }, vorher, signaldateien);
+
+  Punkt ende;
+  for (size_t strang = 0; strang < 2; ++strang) {
+    const size_t erstes = start + 1 + strang * STRANGLAENGE;
+    const double kr = (strang == 0) ? krGerade : krAbzweigend;
+    double r = richtungStrang;
+    Punkt q = verzweigung;
+    for (size_t j = 0; j < STRANGLAENGE; ++j) {
+      const double krElement = (kr == 0) ? 0 : kr * streuung();
+      const Punkt naechster = Bogen(q, r, LAENGE_STRANG, krElement);
+      const size_t nr = erstes + j;
+      const size_t nachGegen = (j == 0) ? start : nr - 1;
+      if (j + 1 < STRANGLAENGE) {
+        schreiber.Element(nr, q, naechster, krElement, FKT_WEICHE, { nr + 1 }, nachGegen);
+      } else if (strang == 0 && weiter != 0) {
+        schreiber.Element(nr, q, naechster, krElement, FKT_WEICHE, { weiter }, nachGegen);
+      } else {
+        schreiber.Element(nr, q, naechster, krElement, FKT_WEICHE, {}, nachGegen);
+      }
+      q = naechster;
+    }
+    if (strang == 0) {
+      ende = q;
+      richtung = r;
+    }
+  }
+  return ende;
+}
+
+// Kruemmung des naechsten Gleiselements ab `p` mit Richtung `richtung`, sodass das Gleis einer archimedischen
+// Spirale um den Ursprung folgt. Die Spirale haelt die Koordinaten auch bei Millionen Elementen im Bereich
+// weniger Kilometer (bei einer Geraden waeren sie so ungenau wie der float-Abstand bei tausenden Kilometern).
+// Richtungsfehler, etwa durch die verbogenen Weichen, werden innerhalb eines Elements ausgeglichen.
+double KruemmungSpirale(Punkt p, double richtung) {
+  const double r = std::hypot(p.x, p.y);
+  const double sollRichtung = std::atan2(p.y, p.x) + M_PI / 2 - std::atan(SPIRALE_ABSTAND / (2 * M_PI * r));
+  const double abweichung = std::remainder(sollRichtung - richtung, 2 * M_PI);
+  return 1 / r + abweichung / LAENGE_GLEIS;
+}
+
+std::string OsPfad(const std::string& verzeichnis, std::string zusiPfad) {
+  std::replace(zusiPfad.begin(), zusiPfad.end(), '\\', '/');
+  return verzeichnis + "/" + zusiPfad;
+}
+
+bool ErzeugeDatei(const std::string& dateiname, std::ofstream& ausgabe) {
+  std::error_code fehler;
+  std::filesystem::create_directories(std::filesystem::path(dateiname).parent_path(), fehler);
+  ausgabe.open(dateiname, std::ios::binary);
+  return static_cast<bool>(ausgabe);
+}
+
+}  // namespace
+
+std::vector<Weichentyp> LiesWeichentypen(const std::string& dateiname) {
+  std::vector<Weichentyp> result;
+  std::ifstream infile(dateiname);
+  std::string line;
+  while (std::getline(infile, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    const auto semicolonPos = line.find(';');
+    if (semicolonPos == std::string::npos) {
+      continue;
+    }
+    Weichentyp typ;
+    typ.muster = line.substr(0, semicolonPos);
+    typ.originalPfad = line.substr(semicolonPos + 1);
+    // Zweiter Teil des Musters ist der Radius, z.B. "54 500 1-12 Links" oder "60_760_1-14fb_Links"
+    const auto trenner = typ.muster.find_first_of(" _");
+    if (trenner != std::string::npos) {
+      typ.radius = std::strtod(typ.muster.c_str() + trenner + 1, nullptr);
+    }
+    typ.links = (typ.muster.find("Links") != std::string::npos);
+    if (typ.radius > 0) {
+      result.push_back(std::move(typ));
+    }
+  }
+  return result;
+}
+
+const Weichentyp& TypDerBogenweiche(const std::vector<Weichentyp>& typen, size_t i) {
+  return typen[i % typen.size()];
+}
+
+std::string PfadVerbogeneLS3(const std::vector<Weichentyp>& typen, size_t i) {
+  return "Gebogen\\" + TypDerBogenweiche(typen, i).muster + " gebogen " + std::to_string(i) + ".ls3";
+}
+
+std::string BeschreibungVerbogeneLS3(double biegung) {
+  return "Bogenweiche"
+    " l=" + Zahl(LAENGE_VERZWEIGUNG, ',') + " kr=" + Zahl(biegung, ',') +
+    " l=" + Zahl(2 * LAENGE_STRANG, ',') + " kr=" + Zahl(biegung * 0.9, ',') +
+    " l=" + Zahl(2 * LAENGE_STRANG, ',') + " kr=" + Zahl(biegung * 1.1, ',');
+}
+
+std::vector<double> ErzeugeStreckendatei(std::ostream& ausgabe, const Generatorparameter& parameter, const std::vector<Weichentyp>& typen) {
+  constexpr double biegekruemmungen[] = { 1 / 1500.0, -1 / 2000.0, 1 / 3000.0 };
+  std::mt19937 zufall(parameter.startwert);
+  std::uniform_real_distribution<double> streuung(0.95, 1.05);
+
+  const size_t anzahlWeichen = typen.empty() ? 0 : parameter.anzahlBogenweichen;
+  const size_t elementeJeWeiche = 1 + 2 * STRANGLAENGE;
+  const size_t anzahlGleis = parameter.anzahlElemente > anzahlWeichen * elementeJeWeiche
+      ? parameter.anzahlElemente - anzahlWeichen * elementeJeWeiche : 0;
+  const size_t anzahl = anzahlGleis + anzahlWeichen * elementeJeWeiche;
+
+  Elementschreiber schreiber(ausgabe);
+  schreiber.Kopf();
+  std::vector<double> result;
+  result.reserve(anzahlWeichen);
+  Punkt p { SPIRALE_RADIUS, 0 };
+  double richtung = M_PI / 2;
+  size_t nr = 1;
+  size_t vorher = 0;  // letztes Element des durchgehenden Gleises
+  // Die Gleiselemente werden gleichmaessig auf die Abschnitte vor, zwischen und nach den Weichen verteilt
+  for (size_t abschnitt = 0; abschnitt <= anzahlWeichen; ++abschnitt) {
+    const size_t anzahlAbschnitt = anzahlGleis * (abschnitt + 1) / (anzahlWeichen + 1) - anzahlGleis * abschnitt / (anzahlWeichen + 1);
+    for (size_t j = 0; j < anzahlAbschnitt; ++j, ++nr) {
+      const double kr = KruemmungSpirale(p, richtung);
+      const Punkt q = Bogen(p, richtung, LAENGE_GLEIS, kr);
+      if (nr < anzahl) {
+        schreiber.Element(nr, p, q, kr, 0, { nr + 1 }, vorher);
+      } else {
+        schreiber.Element(nr, p, q, kr, 0, {}, vorher);
+      }
+      vorher = nr;
+      p = q;
+    }
+    if (abschnitt == anzahlWeichen) {
+      break;
+    }
+
+    const auto& typ = TypDerBogenweiche(typen, abschnitt);
+    const double biegung = biegekruemmungen[zufall() % 3];
+    const double krAbzweigend = (typ.links ? 1 : -1) / typ.radius + biegung;
+    const size_t start = nr;
+    const size_t weiter = (start + elementeJeWeiche <= anzahl) ? start + elementeJeWeiche : 0;
+    p = SchreibeWeiche(schreiber, start, p, richtung, vorher, weiter, biegung, krAbzweigend,
+        { PfadVerbogeneLS3(typen, abschnitt), "Andere\\Antrieb gebogen.ls3" },
+        [&zufall, &streuung]() { return streuung(zufall); });
+    result.push_back(biegung);
+    vorher = start + STRANGLAENGE;
+    nr = start + elementeJeWeiche;
+  }
+  schreiber.Fuss();
+  return result;
+}
+
+void ErzeugeOriginalweiche(std::ostream& ausgabe, const Weichentyp& typ) {
+  Elementschreiber schreiber(ausgabe);
+  schreiber.Kopf();
+  double richtung = 0;
+  std::string ls3 = typ.originalPfad;
+  if (ls3.size() > 4) {
+    ls3.replace(ls3.size() - 4, 4, ".ls3");
+  }
+  SchreibeWeiche(schreiber, 1, Punkt {}, richtung, 0, 0, 0, (typ.links ? 1 : -1) / typ.radius, { ls3 }, []() { return 1.0; });
+  schreiber.Fuss();
+}
+
+bool ErzeugeTestumgebung(const std::string& verzeichnis, const Generatorparameter& parameter, const std::vector<Weichentyp>& typen) {
+  std::ofstream strecke;
+  if (!ErzeugeDatei(verzeichnis + "/strecke.st3", strecke)) {
+    return false;
+  }
+  const auto& biegungen = ErzeugeStreckendatei(strecke, parameter, typen);
+  strecke.close();
+  if (!strecke) {
+    return false;
+  }
+
+  std::ofstream weichen;
+  if (!ErzeugeDatei(verzeichnis + "/weichen.txt", weichen)) {
+    return false;
+  }
+  std::set<size_t> verwendet;
+  for (size_t i = 0; i < biegungen.size() && verwendet.size() < typen.size(); ++i) {
+    verwendet.insert(i % typen.size());
+  }
+  for (const size_t idx : verwendet) {
+    const auto& typ = typen[idx];
+    weichen << typ.muster << ";" << typ.originalPfad << "\n";
+    std::ofstream original;
+    if (!ErzeugeDatei(OsPfad(verzeichnis, typ.originalPfad), original)) {
+      return false;
+    }
+    ErzeugeOriginalweiche(original, typ);
+    if (!original.flush()) {
+      return false;
+    }
+  }
+  if (!weichen.flush()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < biegungen.size(); i += 2) {
+    std::ofstream ls3;
+    if (!ErzeugeDatei(OsPfad(verzeichnis, PfadVerbogeneLS3(typen, i)), ls3)) {
+      return false;
+    }
+    ls3 << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << ZEILENENDE
+      << "<Zusi>" << ZEILENENDE
+      << "<Info DateiTyp=\"Landschaft\" Version=\"A.1\" MinVersion=\"A.1\" Beschreibung=\""
+      << BeschreibungVerbogeneLS3(biegungen[i]) << "\">" << ZEILENENDE
+      << "<AutorEintrag AutorID=\"1\" AutorName=\"Streckengenerator\"/>" << ZEILENENDE
+      << "</Info>" << ZEILENENDE
+      << "<Landschaft/>" << ZEILENENDE
+      << "</Zusi>" << ZEILENENDE;
+    if (!ls3.flush()) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Erzeugt synthetische Streckendateien mit Bogenweichen fuer Messungen ohne echte Zusi-Daten.
+//
+// Die Strecke ist ein durchgehendes Gleis aus schwach gekruemmten Elementen, das einer Spirale folgt
+// (damit die Koordinaten auch bei Millionen Elementen klein bleiben). In gleichen Abstaenden sind
+// Bogenweichen eingefuegt: Verzweigungselement, gerader Strang (setzt das Gleis fort) und
+// abzweigender Strang (Stumpfgleis) mit jeweils STRANGLAENGE Elementen. Alle Verknuepfungen sind in
+// beiden Richtungen mit passendem Anschluss-Attribut eingetragen, die Strecke hat also keine Knicke. Beide Straenge sind um eine
+// zufaellige Biegekruemmung verbogen, die Kruemmungen streuen leicht wie bei echten verbogenen Weichen.
+// Die Weichen werden reihum aus den Typen in weichen.txt gewaehlt. Das erste Signalframe verweist auf
+// "Gebogen\<Muster> gebogen <i>.ls3", sodass FindeWeichen sie als Bogenweichen erkennt
+// und die Weichenzuordnung die unverbogene Weiche findet.
+
+// Bauform einer Weiche aus weichen.txt
+struct Weichentyp {
+  std::string muster;        // Namensmuster aus weichen.txt
+  std::string originalPfad;  // Zusi-Pfad der ST3-Datei der unverbogenen Weiche
+  double radius = 0;         // Radius des abzweigenden Strangs in m, aus dem Muster
+  bool links = false;
+};
+
+struct Generatorparameter {
+  size_t anzahlElemente = 1000;  // Gesamtzahl der Streckenelemente (mindestens so viele wie die Bogenweichen brauchen)
+  size_t anzahlBogenweichen = 10;
+  unsigned int startwert = 1;    // fuer die Zufallszahlen, gleicher Startwert ergibt dieselbe Strecke
+};
+
+// Anzahl Elemente je Strang einer erzeugten Weiche
+constexpr size_t STRANGLAENGE = 4;
+
+// Liest die Weichentypen aus `dateiname` (Format von weichen.txt).
+// Eintraege, aus deren Muster kein Radius hervorgeht, werden uebersprungen.
+std::vector<Weichentyp> LiesWeichentypen(const std::string& dateiname);
+
+// Typ der i-ten Bogenweiche einer erzeugten Strecke
+const Weichentyp& TypDerBogenweiche(const std::vector<Weichentyp>& typen, size_t i);
+
+// Zusi-Pfad der verbogenen LS3-Datei der i-ten Bogenweiche
+std::string PfadVerbogeneLS3(const std::vector<Weichentyp>& typen, size_t i);
+
+// Dateibeschreibung der verbogenen LS3-Datei einer Bogenweiche mit Biegekruemmung `biegung`: Biegeparameter
+// ("l=... kr=...") wie von der Zusi-Weichenbiegung geschrieben, mit Dezimalkomma
+std::string BeschreibungVerbogeneLS3(double biegung);
+
+// Schreibt eine Streckendatei gemaess `parameter` nach `ausgabe` und gibt die Biegekruemmung jeder Bogenweiche zurueck.
+// Die Bogenweichen haben aufsteigende Startelement-Nummern in der Reihenfolge i = 0, 1, ...
+std::vector<double> ErzeugeStreckendatei(std::ostream& ausgabe, const Generatorparameter& parameter, const std::vector<Weichentyp>& typen);
+
+// Schreibt die ST3-Datei der unverbogenen Weiche vom Typ `typ` (eine einzelne Weiche) nach `ausgabe`.
+void ErzeugeOriginalweiche(std::ostream& ausgabe, const Weichentyp& typ);
+
+// Erzeugt unter `verzeichnis` eine vollstaendige Testumgebung fuer radius_bogenweichen:
+// strecke.st3, weichen.txt mit den verwendeten Typen, die ST3-Dateien der unverbogenen Weichen und fuer
+// jede zweite Bogenweiche eine verbogene LS3-Datei mit Biegeparametern in der Dateibeschreibung
+// (die uebrigen muessen aus dem geraden Strang berechnet werden). Die Zusi-Pfade sind relativ zu `verzeichnis`.
+// Gibt false zurueck, wenn eine Datei nicht geschrieben werden konnte.
+bool ErzeugeTestumgebung(const std::string& verzeichnis, const Generatorparameter& parameter, const std::vector<Weichentyp>& typen);
@@ -0,0 +1,42 @@
+#include "streckengraph.hpp"
+
+Streckengraph::Streckengraph(const Strecke& strecke) {
+  const auto& elemente = strecke.children_StrElement;
+  const size_t anzahl = elemente.size();
+  m_funktion.resize(anzahl);
+  m_vorhanden.resize(anzahl);
+  m_anfang.assign(2 * anzahl + 1, 0);
+
+  size_t anzahlVerweise = 0;
+  for (size_t nr = 0; nr < anzahl; ++nr) {
+    if (elemente[nr]) {
+      anzahlVerweise += elemente[nr]->children_NachNorm.size() + elemente[nr]->children_NachGegen.size();
+    }
+  }
+  m_nachfolger.reserve(anzahlVerweise);
+
+  for (size_t nr = 0; nr < anzahl; ++nr) {
+    const auto& el = elemente[nr];
+    if (el) {
+      m_vorhanden[nr] = true;
+      m_funktion[nr] = el->Fkt;
+    }
+    for (const bool norm : { false, true }) {
+      const ElementRichtung er = MitRichtung(nr, norm);
+      if (el) {
+        // wie GetNachfolger: Bit i (Norm) bzw. 8 + i (Gegen) gesetzt -> Nachfolger wird in Gegenrichtung befahren
+        const auto& nachfolgerArray = (norm ? el->children_NachNorm : el->children_NachGegen);
+        for (size_t idx = 0; idx < nachfolgerArray.size(); ++idx) {
+          const auto nachfolgerNr = nachfolgerArray[idx].Nr;
+          if (nachfolgerNr < 0 || static_cast<size_t>(nachfolgerNr) >= anzahl || !elemente[nachfolgerNr]) {
+            m_nachfolger.push_back(KEIN_ELEMENT);
+            continue;
+          }
+          const auto anschlussMaske = (norm ? 0x1 : 0x100) << idx;
+          m_nachfolger.push_back(MitRichtung(nachfolgerNr, (el->Anschluss & anschlussMaske) == 0));
+        }
+      }
+      m_anfang[er + 1] = static_cast<uint32_t>(m_nachfolger.size());
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streckenelement mit Fahrtrichtung als 32-Bit-Wert: Elementnummer im oberen Teil, im untersten Bit
+// 1 fuer Normrichtung und 0 fuer Gegenrichtung. `er ^ 1` ist dasselbe Element in der anderen Richtung.
+using ElementRichtung = uint32_t;
+
+constexpr ElementRichtung KEIN_ELEMENT = UINT32_MAX;
+
+inline ElementRichtung MitRichtung(size_t nr, bool normrichtung) {
+  return static_cast<ElementRichtung>(nr << 1) | (normrichtung ? 1 : 0);
+}
+inline size_t Nummer(ElementRichtung er) { return er >> 1; }
+inline bool Normrichtung(ElementRichtung er) { return er & 1; }
+
+// Nachfolgerstruktur einer Strecke im CSR-Format, einmal pro Strecke aufgebaut.
+// Die Nachfolger von `er` stehen zusammenhaengend in einem Array und tragen bereits die Fahrtrichtung,
+// die sich aus dem Anschluss-Attribut ergibt. Verweise auf nicht vorhandene Elemente bleiben als
+// KEIN_ELEMENT erhalten, damit die Indizes denen in children_NachNorm/children_NachGegen entsprechen.
+class Streckengraph {
+ public:
+  Streckengraph() = default;
+  explicit Streckengraph(const Strecke& strecke);
+
+  size_t anzahlElemente() const { return m_funktion.size(); }  // einschliesslich nicht vorhandener Nummern
+  bool vorhanden(size_t nr) const { return m_vorhanden[nr]; }
+  int32_t funktion(size_t nr) const { return m_funktion[nr]; }  // Fkt-Attribut
+
+  size_t anzahlNachfolger(ElementRichtung er) const { return m_anfang[er + 1] - m_anfang[er]; }
+  ElementRichtung nachfolger(ElementRichtung er, size_t idx) const {
+    return idx < anzahlNachfolger(er) ? m_nachfolger[m_anfang[er] + idx] : KEIN_ELEMENT;
+  }
+  const ElementRichtung* nachfolgerAnfang(ElementRichtung er) const { return m_nachfolger.data() + m_anfang[er]; }
+  const ElementRichtung* nachfolgerEnde(ElementRichtung er) const { return m_nachfolger.data() + m_anfang[er + 1]; }
+
+ private:
+  std::vector<uint32_t> m_anfang;  // Index: ElementRichtung, Laenge 2 * anzahlElemente() + 1
+  std::vector<ElementRichtung> m_nachfolger;
+  std::vector<int32_t> m_funktion;
+  std::vector<bool> m_vorhanden;
+};
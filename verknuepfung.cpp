@@ -0,0 +1,245 @@
+#include "verknuepfung.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Endpunkt `2 * nr` ist der Anfang g, `2 * nr + 1` das Ende b von Element `nr`.
+const Vec3& GetEndpunkt(const StrElement& el, size_t punkt) {
+  return (punkt & 1) ? el.b : el.g;
+}
+
+// Fahrtrichtung beim Verlassen des Elements ueber Endpunkt `punkt` (Sehnenrichtung, nicht normiert)
+void GetAusfahrtrichtung(const StrElement& el, size_t punkt, double (&richtung)[3]) {
+  const auto& von = GetEndpunkt(el, punkt ^ 1);
+  const auto& nach = GetEndpunkt(el, punkt);
+  richtung[0] = nach.X - von.X;
+  richtung[1] = nach.Y - von.Y;
+  richtung[2] = nach.Z - von.Z;
+}
+
+// Ein Element kann nur dann Nachfolger sein, wenn man am gemeinsamen Punkt ohne Richtungsumkehr
+// auf es uebergehen kann. Das schliesst z.B. den jeweils anderen Strang am Weichenanfang aus.
+bool IstNachfolger(const StrElement& el, size_t punkt, const StrElement& nachfolger, size_t punktNachfolger) {
+  double ausfahrt[3];
+  double einfahrt[3];
+  GetAusfahrtrichtung(el, punkt, ausfahrt);
+  GetAusfahrtrichtung(nachfolger, punktNachfolger ^ 1, einfahrt);
+  return ausfahrt[0] * einfahrt[0] + ausfahrt[1] * einfahrt[1] + ausfahrt[2] * einfahrt[2] > 0;
+}
+
+// Raster in der XY-Ebene mit Zellgroesse 8 * `toleranz`. Der Suchbereich um einen Punkt (Quadrat mit Kantenlaenge
+// 2 * `toleranz`) liegt dann in (1 - 2/8)^2 = 56 % der Faelle in einer einzigen Zelle und beruehrt nie mehr als 2x2 Zellen;
+// bei Zellgroesse `toleranz` waeren es immer 2x2 bis 3x3 Eimerzugriffe. Da Elementenden meist Meter auseinanderliegen,
+// enthaelt eine Zelle trotzdem kaum mehr als die Punkte eines Stosses. Punkte mit gleichem X/Y und unterschiedlicher Hoehe (Bruecken)
+// fallen in dieselbe Zelle und werden erst beim Abstandsvergleich getrennt.
+// Die Koordinaten werden nach Eimer sortiert mitgespeichert, damit die Suche die Streckenelemente nicht anfasst.
+class Endpunktraster {
+ public:
+  Endpunktraster(const Strecke& strecke, double toleranz) : m_toleranz(toleranz), m_zellengroesse(8 * toleranz) {
+    const size_t anzahlPunkte = 2 * strecke.children_StrElement.size();
+    size_t anzahlEimer = 1;
+    while (anzahlEimer < anzahlPunkte) {
+      anzahlEimer *= 2;
+    }
+    m_maske = anzahlEimer - 1;
+
+    // Zaehlsortierung der Punkte nach Eimer: m_anfang[e] .. m_anfang[e + 1] sind die Punkte in Eimer e.
+    constexpr uint32_t KEIN_EIMER = UINT32_MAX;
+    std::vector<uint32_t> eimerVonPunkt(anzahlPunkte, KEIN_EIMER);
+    m_anfang.assign(anzahlEimer + 1, 0);
+    for (size_t punkt = 0; punkt < anzahlPunkte; ++punkt) {
+      const auto& el = strecke.children_StrElement[punkt / 2];
+      if (!el) {
+        continue;
+      }
+      const auto& p = GetEndpunkt(*el, punkt);
+      eimerVonPunkt[punkt] = static_cast<uint32_t>(Eimer(Zelle(p.X), Zelle(p.Y)));
+      ++m_anfang[eimerVonPunkt[punkt] + 1];
+    }
+    for (size_t e = 0; e < anzahlEimer; ++e) {
+      m_anfang[e + 1] += m_anfang[e];
+    }
+    m_eintraege.resize(m_anfang[anzahlEimer]);
+    std::vector<uint32_t> fuellstand(m_anfang.begin(), m_anfang.end() - 1);
+    for (size_t punkt = 0; punkt < anzahlPunkte; ++punkt) {
+      if (eimerVonPunkt[punkt] != KEIN_EIMER) {
+        const auto& p = GetEndpunkt(*strecke.children_StrElement[punkt / 2], punkt);
+        m_eintraege[fuellstand[eimerVonPunkt[punkt]]++] = Eintrag { p.X, p.Y, p.Z, static_cast<uint32_t>(punkt) };
+      }
+    }
+  }
+
+  // Ruft `f(punkt)` fuer alle Endpunkte anderer Elemente auf, die hoechstens `toleranz` von `p` entfernt sind.
+  // Derselbe Punkt kann mehrfach gemeldet werden, wenn benachbarte Zellen in denselben Eimer fallen.
+  template<typename F>
+  void FuerAlleNahen(const Vec3& p, size_t nr, F&& f) const {
+    const double toleranzQuadrat = m_toleranz * m_toleranz;
+    for (int64_t zx = Zelle(p.X - m_toleranz), zxEnde = Zelle(p.X + m_toleranz); zx <= zxEnde; ++zx) {
+      for (int64_t zy = Zelle(p.Y - m_toleranz), zyEnde = Zelle(p.Y + m_toleranz); zy <= zyEnde; ++zy) {
+        const auto eimer = Eimer(zx, zy);
+        for (uint32_t i = m_anfang[eimer], ende = m_anfang[eimer + 1]; i < ende; ++i) {
+          const auto& q = m_eintraege[i];
+          if (q.punkt / 2 == nr) {
+            continue;
+          }
+          const double ax = q.x - p.X;
+          const double ay = q.y - p.Y;
+          const double az = q.z - p.Z;
+          if (ax * ax + ay * ay + az * az <= toleranzQuadrat) {
+            f(q.punkt);
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  struct Eintrag {
+    float x, y, z;
+    uint32_t punkt;
+  };
+
+  int64_t Zelle(double koordinate) const {
+    return static_cast<int64_t>(std::floor(koordinate / m_zellengroesse));
+  }
+
+  uint64_t Eimer(int64_t zx, int64_t zy) const {
+    uint64_t h = static_cast<uint64_t>(zx) * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(zy) * 0xC2B2AE3D27D4EB4Full;
+    h ^= h >> 29;
+    return h & m_maske;
+  }
+
+  double m_toleranz;
+  double m_zellengroesse;
+  uint64_t m_maske = 0;
+  std::vector<uint32_t> m_anfang;
+  std::vector<Eintrag> m_eintraege;
+};
+
+double Abstandsquadrat(const Vec3& a, const Vec3& b) {
+  const double dx = a.X - b.X;
+  const double dy = a.Y - b.Y;
+  const double dz = a.Z - b.Z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// Gibt false zurueck, wenn am Endpunkt `punktNachfolger` ein anderes Element als das von `punkt` echt naeher
+// liegt und ebenfalls in den Nachfolger uebergeht. Das ist der Nachbarstrang derselben Weiche: bei grossen
+// Radien liegen die Enden beider Straenge nach einigen Metern nur Millimeter auseinander, der Nachfolger
+// gehoert dann zum eigenen Strang. Gleich weit entfernte Punkte (Weichenanfang) bleiben beide Vorgaenger.
+bool IstNaechsterVorgaenger(const Strecke& strecke, const Endpunktraster& raster, size_t punkt, size_t punktNachfolger) {
+  const auto& nachfolger = *strecke.children_StrElement[punktNachfolger / 2];
+  const auto& q = GetEndpunkt(nachfolger, punktNachfolger);
+  const double abstand = Abstandsquadrat(GetEndpunkt(*strecke.children_StrElement[punkt / 2], punkt), q);
+  bool result = true;
+  if (abstand == 0) {
+    return result;  // kein Punkt kann echt naeher liegen, der haeufigste Fall
+  }
+  raster.FuerAlleNahen(q, punktNachfolger / 2, [&](uint32_t anderer) {
+    if (!result || anderer / 2 == punkt / 2) {
+      return;
+    }
+    const auto& el = *strecke.children_StrElement[anderer / 2];
+    if (Abstandsquadrat(GetEndpunkt(el, anderer), q) < abstand && IstNachfolger(el, anderer, nachfolger, punktNachfolger)) {
+      result = false;
+    }
+  });
+  return result;
+}
+
+// Setzt die Nachfolgerliste an einem Elementende auf die dort gefundenen Endpunkte `punkte` (werden veraendert).
+// `anschluss` erhaelt die Anschlussmaske (Bit i: Nachfolger i an seinem Ende b angeschlossen).
+// Gibt true zurueck, wenn sich die Liste geaendert hat.
+template<typename Nachfolger>
+bool SetzeNachfolger(std::vector<Nachfolger>& nachfolger, std::vector<uint32_t>& punkte, uint32_t& anschluss) {
+  constexpr uint32_t VERWENDET = UINT32_MAX;
+  std::sort(punkte.begin(), punkte.end());
+  punkte.erase(std::unique(punkte.begin(), punkte.end(), [](uint32_t a, uint32_t b) { return a / 2 == b / 2; }), punkte.end());
+
+  // Das Anschluss-Attribut hat nur 8 Bits pro Richtung
+  std::array<uint32_t, 8> neu;
+  size_t anzahl = 0;
+  for (const auto& alt : nachfolger) {
+    for (auto& punkt : punkte) {
+      if (anzahl < neu.size() && punkt != VERWENDET && static_cast<int64_t>(punkt / 2) == alt.Nr) {
+        neu[anzahl++] = punkt;
+        punkt = VERWENDET;
+        break;
+      }
+    }
+  }
+  for (const auto punkt : punkte) {
+    if (anzahl < neu.size() && punkt != VERWENDET) {
+      neu[anzahl++] = punkt;
+    }
+  }
+
+  anschluss = 0;
+  bool geaendert = (anzahl != nachfolger.size());
+  nachfolger.resize(anzahl);
+  for (size_t i = 0; i < anzahl; ++i) {
+    const auto nr = static_cast<int32_t>(neu[i] / 2);
+    geaendert = geaendert || (nachfolger[i].Nr != nr);
+    nachfolger[i].Nr = nr;
+    if (neu[i] & 1) {
+      anschluss |= 1u << i;
+    }
+  }
+  return geaendert;
+}
+
+}  // namespace
+
+size_t VerknuepfeNeu(Strecke& strecke, double toleranz, Arbeitspool& pool) {
+  const Endpunktraster raster(strecke, toleranz);
+  const size_t anzahlElemente = strecke.children_StrElement.size();
+
+  // Jedes Element schreibt nur seine eigenen Nachfolger, das Raster liest nur Koordinaten.
+  constexpr size_t blockgroesse = 4096;
+  std::atomic<size_t> anzahlGeaendert { 0 };
+  pool.ParallelFuer((anzahlElemente + blockgroesse - 1) / blockgroesse, [&](size_t block) {
+    std::vector<uint32_t> punkteNorm;
+    std::vector<uint32_t> punkteGegen;
+    size_t geaendert = 0;
+    for (size_t nr = block * blockgroesse, ende = std::min(anzahlElemente, nr + blockgroesse); nr < ende; ++nr) {
+      auto& el = strecke.children_StrElement[nr];
+      if (!el) {
+        continue;
+      }
+      punkteNorm.clear();
+      punkteGegen.clear();
+      raster.FuerAlleNahen(el->b, nr, [&](uint32_t punkt) {
+        if (IstNachfolger(*el, 2 * nr + 1, *strecke.children_StrElement[punkt / 2], punkt)
+            && IstNaechsterVorgaenger(strecke, raster, 2 * nr + 1, punkt)) {
+          punkteNorm.push_back(punkt);
+        }
+      });
+      raster.FuerAlleNahen(el->g, nr, [&](uint32_t punkt) {
+        if (IstNachfolger(*el, 2 * nr, *strecke.children_StrElement[punkt / 2], punkt)
+            && IstNaechsterVorgaenger(strecke, raster, 2 * nr, punkt)) {
+          punkteGegen.push_back(punkt);
+        }
+      });
+
+      uint32_t anschlussNorm;
+      uint32_t anschlussGegen;
+      const bool nachNormGeaendert = SetzeNachfolger(el->children_NachNorm, punkteNorm, anschlussNorm);
+      const bool nachGegenGeaendert = SetzeNachfolger(el->children_NachGegen, punkteGegen, anschlussGegen);
+      const int32_t anschluss = static_cast<int32_t>((el->Anschluss & ~0xFFFF) | anschlussNorm | (anschlussGegen << 8));
+      if (nachNormGeaendert || nachGegenGeaendert || anschluss != el->Anschluss) {
+        ++geaendert;
+      }
+      el->Anschluss = anschluss;
+    }
+    anzahlGeaendert += geaendert;
+  });
+
+  return anzahlGeaendert;
+}
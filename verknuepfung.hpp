@@ -0,0 +1,18 @@
+#pragma once
+
+#include "zusi_parser/zusi_types.hpp"
+
+#include "arbeitspool.hpp"
+
+#include <cstddef>
+
+// Verknuepft die Streckenelemente anhand ihrer Endpunkte neu, wie es der Editor nach dem ST3-Export tut:
+// Elemente, deren Endpunkte hoechstens `toleranz` Meter auseinanderliegen und die ohne Richtungsumkehr
+// ineinander uebergehen, werden Nachfolger voneinander. Liegt am Anfang des Nachfolgers das Ende eines anderen,
+// ebenfalls passenden Elements echt naeher, wird nur dieses verknuepft (benachbarte Weichenstraenge mit grossem Radius).
+// Setzt children_NachNorm (Nachfolger am Ende b), children_NachGegen (am Anfang g) und die
+// Anschluss-Bits 0-15 (gesetzt, wenn der Nachfolger an seinem Ende b angeschlossen ist).
+// Bereits vorhandene Nachfolger behalten ihre Reihenfolge, neue werden nach Nummer sortiert angehaengt.
+// Die Endpunkte werden in ein Raster mit Zellgroesse 8 * `toleranz` gehasht (Begruendung in verknuepfung.cpp),
+// der Aufwand ist also linear in der Anzahl der Elemente. Gibt die Anzahl der Elemente zurueck, deren Verknuepfung sich geaendert hat.
+size_t VerknuepfeNeu(Strecke& strecke, double toleranz, Arbeitspool& pool);
@@ -0,0 +1,128 @@
+// Prueft VerknuepfeNeu auf einer erzeugten Strecke (siehe streckengenerator.hpp): Eine richtig verknuepfte Strecke
+// bleibt unveraendert, auch bei Weichen mit grossem Radius, deren Straenge nach einigen Metern naeher als die
+// Toleranz beieinanderliegen. Eine Strecke ganz ohne Verknuepfungen erhaelt dieselben Nachfolger zurueck.
+// Die Testdatei wird im aktuellen Verzeichnis angelegt.
+
+#include "arbeitspool.hpp"
+#include "protokoll.hpp"
+#include "streckendatei.hpp"
+#include "streckengenerator.hpp"
+#include "verknuepfung.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int anzahlFehler = 0;
+
+void Pruefe(bool bedingung, const char* beschreibung) {
+  if (!bedingung) {
+    std::cout << "FEHLER: " << beschreibung << "\n";
+    ++anzahlFehler;
+  }
+}
+
+const std::string DATEINAME = "verknuepfung_test.st3";
+constexpr double TOLERANZ = 0.01;  // Standardwert von --verknuepfen
+
+// Verknuepfung eines Elements, wie sie VerknuepfeNeu setzt
+struct Verknuepfung {
+  std::vector<int32_t> nachNorm;
+  std::vector<int32_t> nachGegen;
+  int32_t anschluss = 0;
+
+  bool operator==(const Verknuepfung& other) const {
+    return nachNorm == other.nachNorm && nachGegen == other.nachGegen && anschluss == other.anschluss;
+  }
+};
+
+std::vector<Verknuepfung> GetVerknuepfungen(const Strecke& strecke) {
+  std::vector<Verknuepfung> result(strecke.children_StrElement.size());
+  for (size_t nr = 0; nr < strecke.children_StrElement.size(); ++nr) {
+    const auto& el = strecke.children_StrElement[nr];
+    if (!el) {
+      continue;
+    }
+    for (const auto& nachfolger : el->children_NachNorm) {
+      result[nr].nachNorm.push_back(nachfolger.Nr);
+    }
+    for (const auto& nachfolger : el->children_NachGegen) {
+      result[nr].nachGegen.push_back(nachfolger.Nr);
+    }
+    result[nr].anschluss = el->Anschluss;
+  }
+  return result;
+}
+
+// Meldet die ersten Elemente, deren Verknuepfung von `erwartet` abweicht.
+void PruefeVerknuepfungen(const Strecke& strecke, const std::vector<Verknuepfung>& erwartet, const char* beschreibung) {
+  const auto& verknuepfungen = GetVerknuepfungen(strecke);
+  size_t anzahlAbweichungen = 0;
+  for (size_t nr = 0; nr < verknuepfungen.size(); ++nr) {
+    if (!(verknuepfungen[nr] == erwartet[nr]) && ++anzahlAbweichungen <= 5) {
+      std::cout << "  Element " << nr << ": " << verknuepfungen[nr].nachNorm.size() << " Nachfolger in Normrichtung, "
+        << verknuepfungen[nr].nachGegen.size() << " in Gegenrichtung, Anschluss " << verknuepfungen[nr].anschluss << "\n";
+    }
+  }
+  Pruefe(anzahlAbweichungen == 0, beschreibung);
+}
+
+}  // namespace
+
+int main() {
+  // Weichen mit kleinem und grossem Radius abwechselnd. Bei R 4000 liegen die Enden der ersten Elemente
+  // beider Straenge (8 m) nur 8 mm auseinander.
+  std::vector<Weichentyp> typen(2);
+  typen[0].muster = "54 300 1-9 Links";
+  typen[0].originalPfad = "Weichen\\54_300_1-9_Links.st3";
+  typen[0].radius = 300;
+  typen[0].links = true;
+  typen[1].muster = "60 4000 1-40 Rechts";
+  typen[1].originalPfad = "Weichen\\60_4000_1-40_Rechts.st3";
+  typen[1].radius = 4000;
+
+  Generatorparameter parameter;
+  parameter.anzahlElemente = 5000;
+  parameter.anzahlBogenweichen = 100;
+  {
+    std::ofstream datei(DATEINAME, std::ios::binary | std::ios::trunc);
+    ErzeugeStreckendatei(datei, parameter, typen);
+  }
+
+  Arbeitspool pool(4);
+  std::ostringstream meldungen;
+  Protokoll log(meldungen, Ausgabestufe::Fehler);
+  const auto datei = LiesStreckendatei(DATEINAME, Leseoptionen {}, log);
+  std::remove(DATEINAME.c_str());
+  if (!datei || !datei->zusi->Strecke) {
+    std::cout << "FEHLER: Erzeugte Strecke nicht lesbar\n" << meldungen.str();
+    return 1;
+  }
+  auto& strecke = *datei->zusi->Strecke;
+  const auto& erzeugt = GetVerknuepfungen(strecke);
+
+  // Erneutes Verknuepfen aendert nichts
+  Pruefe(VerknuepfeNeu(strecke, TOLERANZ, pool) == 0, "Richtig verknuepfte Strecke: keine Aenderung gemeldet");
+  PruefeVerknuepfungen(strecke, erzeugt, "Richtig verknuepfte Strecke: Nachfolger und Anschluss unveraendert");
+
+  // Ohne Verknuepfungen werden alle wiederhergestellt
+  for (auto& el : strecke.children_StrElement) {
+    if (el) {
+      el->children_NachNorm.clear();
+      el->children_NachGegen.clear();
+      el->Anschluss = 0;
+    }
+  }
+  Pruefe(VerknuepfeNeu(strecke, TOLERANZ, pool) == parameter.anzahlElemente, "Unverknuepfte Strecke: alle Elemente geaendert");
+  PruefeVerknuepfungen(strecke, erzeugt, "Unverknuepfte Strecke: Nachfolger und Anschluss wie erzeugt");
+
+  if (anzahlFehler == 0) {
+    std::cout << "verknuepfung_test: ok\n";
+  }
+  return anzahlFehler == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "xmlleser.hpp"
+
+bool XmlLeser::NaechstesKind(XmlTag& tag) {
+  while (SucheTag()) {
+    if (m_pos >= m_grenze) {
+      m_grenzeErreicht = true;
+      return false;
+    }
+    if (m_pos + 1 >= m_text.size()) {
+      Fehler("Unvollstaendiges Tag");
+    }
+    const char c = m_text[m_pos + 1];
+    if (c == '?' || c == '!') {
+      UeberspringeSonderTag();
+    } else if (c == '/') {
+      if (m_tiefe == 0) {
+        Fehler("End-Tag ohne Start-Tag");
+      }
+      LiesEndTag();
+      --m_tiefe;
+      return false;
+    } else {
+      LiesStartTag(tag);
+      if (!tag.leer) {
+        ++m_tiefe;
+      }
+      return true;
+    }
+  }
+  if (m_tiefe != 0) {
+    Fehler("Unerwartetes Dateiende");
+  }
+  return false;
+}
+
+void XmlLeser::Ueberspringe(size_t tiefe) {
+  XmlTag tag;
+  while (m_tiefe > tiefe && !m_grenzeErreicht) {
+    NaechstesKind(tag);
+  }
+}
+
+void XmlLeser::UeberspringeSonderTag() {
+  const auto rest = m_text.substr(m_pos);
+  std::string_view ende = ">";
+  if (rest.compare(0, 4, "<!--") == 0) {
+    ende = "-->";
+  } else if (rest.compare(0, 9, "<![CDATA[") == 0) {
+    ende = "]]>";
+  } else if (rest.compare(0, 2, "<?") == 0) {
+    ende = "?>";
+  }
+  const auto pos = m_text.find(ende, m_pos + 2);
+  if (pos == std::string_view::npos) {
+    Fehler("Unerwartetes Dateiende");
+  }
+  m_pos = pos + ende.size();
+}
+
+void XmlLeser::LiesStartTag(XmlTag& tag) {
+  const size_t nameAnfang = m_pos + 1;
+  size_t pos = m_scanner.Suche(nameAnfang, NAMENSENDE);
+  if (pos == nameAnfang) {
+    Fehler("Tag ohne Namen");
+  }
+  tag.name = m_text.substr(nameAnfang, pos - nameAnfang);
+
+  // '>' innerhalb von Attributwerten ueberspringen
+  const size_t attributAnfang = pos;
+  while (true) {
+    pos = SucheBisEnde(pos, TAG_ENDE | ANFUEHRUNGSZEICHEN | APOSTROPH);
+    if (m_text[pos] == '>') {
+      break;
+    }
+    pos = SucheBisEnde(pos + 1, m_text[pos] == '"' ? ANFUEHRUNGSZEICHEN : APOSTROPH) + 1;
+  }
+  tag.leer = (m_text[pos - 1] == '/');
+  tag.attribute = m_text.substr(attributAnfang, pos - attributAnfang - (tag.leer ? 1 : 0));
+  m_pos = pos + 1;
+}
+
+void XmlLeser::LiesEndTag() {
+  m_pos = SucheBisEnde(m_pos + 2, TAG_ENDE) + 1;
+}
+
+bool XmlLeser::SucheTag() {
+  m_pos = m_scanner.Suche(m_pos, TAG_ANFANG);
+  return m_pos < m_text.size();
+}
+
+size_t XmlLeser::SucheBisEnde(size_t pos, unsigned klassen) {
+  pos = m_scanner.Suche(pos, klassen);
+  if (pos >= m_text.size()) {
+    Fehler("Unerwartetes Dateiende");
+  }
+  return pos;
+}
+
+void XmlLeser::Fehler(const char* meldung) const {
+  throw XmlFehler(meldung, m_pos);
+}
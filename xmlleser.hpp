@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "xmlscanner.hpp"
+
+// Fehler im XML-Text, mit Byteposition relativ zum Anfang des Textes.
+class XmlFehler : public std::runtime_error {
+ public:
+  XmlFehler(const std::string& meldung, size_t position) : std::runtime_error(meldung), m_position(position) {}
+  size_t position() const { return m_position; }
+
+ private:
+  size_t m_position;
+};
+
+// Start-Tag eines Elements. `attribute` ist der Text zwischen Name und '>' bzw. "/>",
+// alle string_views zeigen in den gelesenen Text.
+struct XmlTag {
+  std::string_view name;
+  std::string_view attribute;
+  bool leer = false;  // <Name ... /> ohne Inhalt
+};
+
+// Liest ein XML-Dokument vorwaerts Tag fuer Tag, ohne einen Baum aufzubauen.
+// Der Aufrufer steigt nur in die Elemente ab, die er braucht; alle anderen werden in einem schnellen
+// Durchlauf uebersprungen, der nur Tags zaehlt. Text, Kommentare, Processing Instructions, CDATA und
+// DOCTYPE werden ignoriert, Entities nicht ersetzt. Geprueft wird nur, ob Tags vollstaendig und
+// Start- und End-Tags gleich oft vorhanden sind. Bei Fehlern wird XmlFehler geworfen.
+// Tag- und Attributgrenzen werden mit XmlScanner gesucht.
+class XmlLeser {
+ public:
+  explicit XmlLeser(std::string_view text) : m_text(text), m_scanner(text) {}
+
+  // Liest nur einen Abschnitt des Dokuments `text`, der bei `anfang` auf Tiefe `tiefe` beginnt
+  // (Anzahl der offenen Elemente). Sobald ein Tag bei oder hinter `grenze` beginnt, verhaelt sich der Leser,
+  // als waeren alle offenen Elemente zu Ende, und grenzeErreicht() ist true.
+  XmlLeser(std::string_view text, size_t anfang, size_t tiefe, size_t grenze)
+    : m_text(text), m_scanner(text), m_pos(anfang), m_tiefe(tiefe), m_grenze(grenze) {}
+
+  // Ruft `f(kind)` fuer jedes Element auf oberster Ebene auf.
+  template<typename F>
+  void FuerAlleElemente(F&& f) {
+    FuerAlleKinder(XmlTag {}, f);
+  }
+
+  // Ruft `f(kind)` fuer jedes Kindelement des eben gelesenen Elements `tag` auf.
+  // Kinder, die `f` nicht selbst mit FuerAlleKinder liest, werden uebersprungen.
+  template<typename F>
+  void FuerAlleKinder(const XmlTag& tag, F&& f) {
+    if (tag.leer) {
+      return;
+    }
+    const size_t tiefe = m_tiefe;
+    XmlTag kind;
+    while (NaechstesKind(kind)) {
+      f(kind);
+      if (m_tiefe > tiefe) {
+        Ueberspringe(tiefe);
+      }
+    }
+  }
+
+  // Liest bis zum Dokumentende und prueft dabei nur noch die Struktur.
+  void UeberspringeRest() {
+    Ueberspringe(0);
+    FuerAlleElemente([](const XmlTag&) {});
+  }
+
+  // Position im Text, bis zu der gelesen wurde
+  size_t position() const { return m_pos; }
+
+  // Anzahl der offenen Elemente
+  size_t tiefe() const { return m_tiefe; }
+
+  bool grenzeErreicht() const { return m_grenzeErreicht; }
+
+ private:
+  // Liest das naechste Start-Tag auf der aktuellen Ebene. Gibt false zurueck, wenn stattdessen
+  // das End-Tag des umgebenden Elements (wird verbraucht) oder das Dokumentende erreicht wurde.
+  bool NaechstesKind(XmlTag& tag);
+
+  // Liest bis zum End-Tag zurueck auf Tiefe `tiefe` (oder bis zur Grenze).
+  void Ueberspringe(size_t tiefe);
+
+  // Steht auf '<' eines Tags, das kein Element ist (<? <! <!-- <![CDATA[), und liest dahinter weiter.
+  void UeberspringeSonderTag();
+
+  // Liest ab dem Namen eines Start-Tags bis hinter das schliessende '>'.
+  void LiesStartTag(XmlTag& tag);
+
+  // Liest ab dem Namen eines End-Tags bis hinter das schliessende '>'.
+  void LiesEndTag();
+
+  // Springt zum naechsten '<'. Gibt false zurueck, wenn keines mehr folgt.
+  bool SucheTag();
+
+  // Position des naechsten Zeichens aus `klassen` ab `pos`, wirft am Textende.
+  size_t SucheBisEnde(size_t pos, unsigned klassen);
+
+  [[noreturn]] void Fehler(const char* meldung) const;
+
+  std::string_view m_text;
+  XmlScanner m_scanner;
+  size_t m_pos = 0;
+  size_t m_tiefe = 0;
+  size_t m_grenze = std::string_view::npos;
+  bool m_grenzeErreicht = false;
+};
+
+// Ruft `f(name, wert)` fuer alle Attribute eines Start-Tags auf. Der Wert ist nicht dekodiert
+// und zeigt in den gelesenen Text, direkt vor das schliessende Anfuehrungszeichen.
+template<typename F>
+void FuerAlleAttribute(const XmlTag& tag, F&& f) {
+  const auto istLeerzeichen = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+  const std::string_view text = tag.attribute;
+  size_t pos = 0;
+  while (true) {
+    while (pos < text.size() && istLeerzeichen(text[pos])) {
+      ++pos;
+    }
+    const size_t nameAnfang = pos;
+    while (pos < text.size() && text[pos] != '=' && !istLeerzeichen(text[pos])) {
+      ++pos;
+    }
+    const auto name = text.substr(nameAnfang, pos - nameAnfang);
+    while (pos < text.size() && text[pos] != '"' && text[pos] != '\'') {
+      ++pos;
+    }
+    if (name.empty() || pos >= text.size()) {
+      return;
+    }
+    const auto wertEnde = text.find(text[pos], pos + 1);
+    if (wertEnde == std::string_view::npos) {
+      return;
+    }
+    f(name, text.substr(pos + 1, wertEnde - pos - 1));
+    pos = wertEnde + 1;
+  }
+}
@@ -0,0 +1,99 @@
+// Misst den Durchsatz des ST3-Lesers auf einer gegebenen Datei:
+//  - Strukturdurchlauf: alle Tags der Datei mit XmlLeser besuchen, ohne Objekte anzulegen
+//  - Einlesen: LiesStreckendatei (Projektion auf die Streckenelemente), sequentiell und parallel
+// Aufruf: xmlleser_bench <datei.st3> [Wiederholungen]
+
+#include "arbeitspool.hpp"
+#include "dateiinhalt.hpp"
+#include "protokoll.hpp"
+#include "streckendatei.hpp"
+#include "xmlleser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Besucht rekursiv alle Elemente und zaehlt sie.
+struct Elementzaehler {
+  XmlLeser& leser;
+  size_t anzahl = 0;
+
+  void operator()(const XmlTag& tag) {
+    ++anzahl;
+    leser.FuerAlleKinder(tag, *this);
+  }
+};
+
+// Fuehrt `f` `wiederholungen` mal aus und gibt die kuerzeste Laufzeit in Sekunden zurueck.
+template<typename F>
+double KuerzesteLaufzeit(int wiederholungen, F&& f) {
+  double result = 0;
+  for (int i = 0; i < wiederholungen; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const double dauer = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result = (i == 0) ? dauer : std::min(result, dauer);
+  }
+  return result;
+}
+
+void PrintDurchsatz(const char* name, size_t bytes, double sekunden) {
+  std::cout << name << ": " << (sekunden * 1000) << " ms, " << (bytes / sekunden / 1e9) << " GB/s\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cout << "Aufruf: " << argv[0] << " <datei.st3> [Wiederholungen]\n";
+    return 1;
+  }
+  const std::string dateiname = argv[1];
+  const int wiederholungen = std::max(1, argc > 2 ? atoi(argv[2]) : 5);
+
+  Dateiinhalt inhalt;
+  if (!inhalt.Lies(dateiname, true)) {
+    std::cout << "Fehler beim Lesen von " << dateiname << "\n";
+    return 1;
+  }
+  std::cout << dateiname << ": " << inhalt.size() << " Bytes, Scanner: " << XmlScanner::Befehlssatz()
+    << ", beste von " << wiederholungen << " Wiederholungen\n";
+
+  size_t anzahlElemente = 0;
+  try {
+    const double dauer = KuerzesteLaufzeit(wiederholungen, [&inhalt, &anzahlElemente]() {
+      XmlLeser leser({ inhalt.data(), inhalt.size() });
+      Elementzaehler zaehler { leser };
+      leser.FuerAlleElemente(zaehler);
+      anzahlElemente = zaehler.anzahl;
+    });
+    PrintDurchsatz("Strukturdurchlauf", inhalt.size(), dauer);
+  } catch (const XmlFehler& e) {
+    std::cout << "XML-Fehler: " << e.what() << " (Byte " << e.position() << ")\n";
+    return 1;
+  }
+  std::cout << "  " << anzahlElemente << " Elemente\n";
+
+  Protokoll log(std::cout, Ausgabestufe::Fehler);
+  size_t anzahlStreckenelemente = 0;
+  const double dauer = KuerzesteLaufzeit(wiederholungen, [&]() {
+    const auto& datei = LiesStreckendatei(dateiname, Leseoptionen {}, log);
+    anzahlStreckenelemente = (datei && datei->zusi->Strecke) ? datei->zusi->Strecke->children_StrElement.size() : 0;
+  });
+  PrintDurchsatz("Einlesen", inhalt.size(), dauer);
+  std::cout << "  " << anzahlStreckenelemente << " Streckenelemente\n";
+
+  Arbeitspool pool(std::max(1u, std::thread::hardware_concurrency()));
+  const double dauerParallel = KuerzesteLaufzeit(wiederholungen, [&]() {
+    const auto& datei = LiesStreckendatei(dateiname, Leseoptionen {}, pool, log);
+    anzahlStreckenelemente = (datei && datei->zusi->Strecke) ? datei->zusi->Strecke->children_StrElement.size() : 0;
+  });
+  PrintDurchsatz("Einlesen parallel", inhalt.size(), dauerParallel);
+  std::cout << "  " << anzahlStreckenelemente << " Streckenelemente, " << pool.anzahlThreads() << " Threads\n";
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include "xmlscanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define XMLSCANNER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XMLSCANNER_SSE2
+#endif
+
+namespace {
+
+// Operationen auf einem Vektor von `breite` Bytes. Vergleiche liefern pro Byte 0xFF oder 0,
+// Maske() fasst sie zu einem Bit pro Byte zusammen (Bit i fuer Byte i).
+#if defined(XMLSCANNER_AVX2)
+struct Bytes {
+  using V = __m256i;
+  static constexpr size_t breite = 32;
+  static constexpr const char* name = "AVX2";
+
+  static V Laden(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  static V Gleich(V a, char c) { return _mm256_cmpeq_epi8(a, _mm256_set1_epi8(c)); }
+  static V KleinerGleich(V a, char c) { return _mm256_cmpeq_epi8(_mm256_max_epu8(a, _mm256_set1_epi8(c)), _mm256_set1_epi8(c)); }
+  static V Oder(V a, V b) { return _mm256_or_si256(a, b); }
+  static uint64_t Maske(V a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+};
+#elif defined(XMLSCANNER_SSE2)
+struct Bytes {
+  using V = __m128i;
+  static constexpr size_t breite = 16;
+  static constexpr const char* name = "SSE2";
+
+  static V Laden(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static V Gleich(V a, char c) { return _mm_cmpeq_epi8(a, _mm_set1_epi8(c)); }
+  static V KleinerGleich(V a, char c) { return _mm_cmpeq_epi8(_mm_max_epu8(a, _mm_set1_epi8(c)), _mm_set1_epi8(c)); }
+  static V Oder(V a, V b) { return _mm_or_si128(a, b); }
+  static uint64_t Maske(V a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+};
+#else
+struct Bytes {
+  using V = unsigned char;
+  static constexpr size_t breite = 1;
+  static constexpr const char* name = "skalar";
+
+  static V Laden(const char* p) { return static_cast<unsigned char>(*p); }
+  static V Gleich(V a, char c) { return a == static_cast<unsigned char>(c); }
+  static V KleinerGleich(V a, char c) { return a <= static_cast<unsigned char>(c); }
+  static V Oder(V a, V b) { return a | b; }
+  static uint64_t Maske(V a) { return a; }
+};
+#endif
+
+}  // namespace
+
+const char* XmlScanner::Befehlssatz() {
+  return Bytes::name;
+}
+
+void XmlScanner::LadeBlock(size_t block) {
+  m_block = block;
+  const size_t anfang = block * BLOCKGROESSE;
+  const size_t laenge = std::min(BLOCKGROESSE, m_text.size() - anfang);
+  const char* daten = m_text.data() + anfang;
+
+  // Letzten, unvollstaendigen Block in einen Puffer kopieren, die Bits dahinter werden ausmaskiert
+  char puffer[BLOCKGROESSE];
+  if (laenge < BLOCKGROESSE) {
+    std::memset(puffer, 0, sizeof(puffer));
+    std::memcpy(puffer, daten, laenge);
+    daten = puffer;
+  }
+
+  for (auto& maske : m_masken) {
+    maske = 0;
+  }
+  for (size_t i = 0; i < BLOCKGROESSE; i += Bytes::breite) {
+    const auto v = Bytes::Laden(daten + i);
+    const auto tagEnde = Bytes::Gleich(v, '>');
+    m_masken[0] |= Bytes::Maske(Bytes::Gleich(v, '<')) << i;
+    m_masken[1] |= Bytes::Maske(tagEnde) << i;
+    m_masken[2] |= Bytes::Maske(Bytes::Gleich(v, '"')) << i;
+    m_masken[3] |= Bytes::Maske(Bytes::Gleich(v, '\'')) << i;
+    m_masken[4] |= Bytes::Maske(Bytes::Oder(Bytes::Oder(Bytes::KleinerGleich(v, ' '), tagEnde),
+        Bytes::Oder(Bytes::Gleich(v, '/'), Bytes::Gleich(v, '=')))) << i;
+  }
+
+  if (laenge < BLOCKGROESSE) {
+    const uint64_t gueltig = (uint64_t { 1 } << laenge) - 1;
+    for (auto& maske : m_masken) {
+      maske &= gueltig;
+    }
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Klassen von Zeichen, die in XML Tags und Attribute begrenzen, als Bitmaske kombinierbar.
+enum Strukturzeichen : unsigned {
+  TAG_ANFANG = 1 << 0,          // '<'
+  TAG_ENDE = 1 << 1,            // '>'
+  ANFUEHRUNGSZEICHEN = 1 << 2,  // '"'
+  APOSTROPH = 1 << 3,           // '\''
+  NAMENSENDE = 1 << 4,          // ' ', Steuerzeichen, '/', '=', '>'
+};
+
+// Vektorisierte Suche nach Strukturzeichen, aehnlich der ersten Stufe von simdjson.
+// Der Text wird in Bloecken von 64 Bytes klassifiziert: pro Block und Zeichenklasse entsteht eine
+// Bitmaske mit einem Bit pro Byte. Suchen innerhalb desselben Blocks kosten danach nur noch ein paar
+// Bitoperationen, jedes Byte wird hoechstens einmal mit Vektorbefehlen angefasst.
+// Je nach Uebersetzung mit AVX2 (CMake-Option RADIUS_BOGENWEICHEN_AVX2 fuer das ganze Programm, 2 x 32 Bytes)
+// oder SSE2 (4 x 16 Bytes), ohne SIMD byteweise. Gelesen wird nie ausserhalb des Textes.
+class XmlScanner {
+ public:
+  static constexpr size_t BLOCKGROESSE = 64;
+
+  explicit XmlScanner(std::string_view text) : m_text(text) {}
+
+  // Position des ersten Zeichens ab `pos`, das zu einer der Klassen in `klassen` gehoert, sonst Textlaenge.
+  size_t Suche(size_t pos, unsigned klassen) {
+    while (pos < m_text.size()) {
+      const size_t block = pos / BLOCKGROESSE;
+      if (block != m_block) {
+        LadeBlock(block);
+      }
+      uint64_t treffer = 0;
+      for (size_t klasse = 0; klasse < ANZAHL_KLASSEN; ++klasse) {
+        if (klassen & (1u << klasse)) {
+          treffer |= m_masken[klasse];
+        }
+      }
+      treffer &= ~uint64_t { 0 } << (pos % BLOCKGROESSE);
+      if (treffer != 0) {
+        return block * BLOCKGROESSE + ErstesBit(treffer);
+      }
+      pos = (block + 1) * BLOCKGROESSE;
+    }
+    return m_text.size();
+  }
+
+  // Befehlssatz, mit dem der Scanner uebersetzt wurde ("AVX2", "SSE2" oder "skalar")
+  static const char* Befehlssatz();
+
+ private:
+  static constexpr size_t ANZAHL_KLASSEN = 5;
+
+  static size_t ErstesBit(uint64_t maske) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, maske);
+    return idx;
+#else
+    return static_cast<size_t>(__builtin_ctzll(maske));
+#endif
+  }
+
+  // Berechnet m_masken fuer Block `block`. Bits hinter dem Textende sind 0.
+  void LadeBlock(size_t block);
+
+  std::string_view m_text;
+  size_t m_block = SIZE_MAX;
+  uint64_t m_masken[ANZAHL_KLASSEN] = {};
+};